@@ -0,0 +1,953 @@
+#include <stdio.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+
+/*
+    Converts a VCD into a table with one row per time step in which a signal changed, in a single pass over the VCD.
+
+    A VCD lists its value changes in time order, so each row is complete as soon as the next time step starts and is
+    written right away. Only the latest value of every signal is kept, memory does not depend on the length of the
+    VCD. The table is written as CSV, a cell holds the value its signal changed to in that time step and stays empty
+    if the signal did not change (--hold fills it with the value the signal holds), or in a binary columnar format.
+
+    Binary format, all integers little endian:
+
+    File header:
+        magic "CSTT", version (u8), reserved (u8, u16), number of columns (u32), reserved (u32), number of rows (u64,
+        0 if the table was written to a pipe, the blocks then run to the end of the file),
+        timescale: length (u16) and its characters, e.g. "1 ns"
+        per column: width in bits (u16), kind (u8, TABLE_VECTOR or TABLE_REAL), reserved (u8), length of the name
+        (u16) and its characters
+
+    Then the blocks, each holding up to TABLE_BLOCK_ROWS rows:
+        number of rows (u32)
+        time column: the time of every row (u64 per row)
+        per column: changed bitmap, unknown bitmap (one bit per row each, least significant bit first, padded to whole
+        bytes) and the value the signal holds in every row (u64 per row)
+
+    A value is the low 64 bits of a vector or the bits of a double for a real. The unknown bit is set for vectors with
+    x or z bits, which read as 0, and for rows before the first value of the signal.
+*/
+
+#define TABLE_MAGIC "CSTT"
+#define TABLE_VERSION 1
+#define TABLE_VECTOR 0 // Scalars and vectors
+#define TABLE_REAL 1
+#define TABLE_BLOCK_ROWS 65536 // Rows per block of the binary format
+#define READ_BUFFER (1 << 20) // Bytes of the VCD read at a time
+#define DEFAULT_CSV "signal_changes.csv"
+#define DEFAULT_BINARY "signal_changes.bin"
+
+// Signal of the VCD, one per identifier code
+struct Signal
+{
+    char* id; // Identifier code
+    char* name; // Hierarchical name, scopes separated by dots
+    const char* reference; // Name without the scopes, points into name
+    unsigned width; // Bits
+    int kind; // TABLE_VECTOR or TABLE_REAL
+    int column; // Column of the table, -1 if the signal is filtered out
+    char* text; // Latest value as it appears in the VCD
+    size_t textCapacity;
+    uint64_t value; // Latest value, see the binary format
+    int unknown; // The latest value has x or z bits or there is none yet
+    int changed; // Changed in the pending row
+};
+
+// Tokenizer of the VCD, tokens are separated by white space
+struct Reader
+{
+    FILE* file;
+    char* buffer;
+    size_t size; // Bytes in buffer
+    size_t position; // Next byte to look at
+    char* token; // Last token read, null terminated
+    size_t length;
+    size_t capacity;
+    char* held; // Value of a vector or real change kept while its identifier code is read
+    size_t heldCapacity;
+};
+
+// Output table, the rows are written as soon as they are complete
+struct Table
+{
+    FILE* file;
+    int binary;
+    int hold; // CSV cells of signals that did not change hold their value instead of staying empty
+    struct Signal** columns;
+    unsigned numColumns;
+    uint64_t numRows;
+    // Block of the binary format
+    uint64_t* times;
+    uint64_t* values; // TABLE_BLOCK_ROWS values per column
+    uint8_t* changed; // Bitmap per column
+    uint8_t* unknown; // Bitmap per column
+    unsigned blockRows;
+    uint8_t* encoded; // Block in the file format
+};
+
+int toUnsigned64(const char* optarg, uint64_t max, uint64_t* result)
+{
+    char* endptr;
+    unsigned long long val;
+
+    errno = 0;
+    val = strtoull(optarg, &endptr, 0); // Decimal, or hexadecimal with 0x
+    if (errno != 0 || endptr == optarg || *endptr != '\0' || strchr(optarg, '-') || val > max)
+    {
+        return -1;
+    }
+    *result = (uint64_t)val;
+    return 0;
+}
+
+/*
+    Stores an integer in little endian byte order
+    parameters:
+        out: destination
+        value: the integer
+        bytes: number of bytes stored
+    returns: -
+*/
+static void storeLittleEndian(uint8_t* out, uint64_t value, unsigned bytes)
+{
+    for (unsigned i = 0; i < bytes; i++)
+    {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/*
+    Reads the next token of the VCD
+    parameters:
+        reader: the reader
+    returns: 1 with the token in reader->token, 0 at the end of the file
+*/
+static int nextToken(struct Reader* reader)
+{
+    reader->length = 0;
+    while (1)
+    {
+        if (reader->position == reader->size)
+        {
+            reader->size = fread(reader->buffer, 1, READ_BUFFER, reader->file);
+            reader->position = 0;
+            if (reader->size == 0)
+            {
+                break;
+            }
+        }
+        const char c = reader->buffer[reader->position++];
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+        {
+            if (reader->length != 0)
+            {
+                break;
+            }
+            continue;
+        }
+        if (reader->length + 1 >= reader->capacity)
+        {
+            char* grown = realloc(reader->token, reader->capacity * 2);
+            if (!grown)
+            {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+            reader->token = grown;
+            reader->capacity *= 2;
+        }
+        reader->token[reader->length++] = c;
+    }
+    reader->token[reader->length] = '\0';
+    return reader->length != 0;
+}
+
+/*
+    Keeps the last token in the second buffer of the reader, the next token is read into the other one
+    parameters:
+        reader: the reader
+    returns: -
+*/
+static void holdToken(struct Reader* reader)
+{
+    char* token = reader->token;
+    const size_t capacity = reader->capacity;
+    reader->token = reader->held;
+    reader->capacity = reader->heldCapacity;
+    reader->held = token;
+    reader->heldCapacity = capacity;
+}
+
+/*
+    Skips the tokens up to and including the next $end
+    parameters:
+        reader: the reader
+    returns: 0 on success, -1 if the file ended first
+*/
+static int skipToEnd(struct Reader* reader)
+{
+    while (nextToken(reader))
+    {
+        if (strcmp(reader->token, "$end") == 0)
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+    Copies a string
+    parameters:
+        text: the string
+        length: its length
+    returns: the copy (exits if it cannot be allocated)
+*/
+static char* copyString(const char* text, size_t length)
+{
+    char* copy = malloc(length + 1);
+    if (!copy)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+/*
+    Stores a value change of a signal as its latest value
+    parameters:
+        signal: the signal
+        text: the value as it appears in the VCD, without the leading b or r of vectors and reals
+        length: length of the value
+    returns: -
+*/
+static void changeSignal(struct Signal* signal, const char* text, size_t length)
+{
+    if (length + 1 > signal->textCapacity)
+    {
+        free(signal->text);
+        signal->textCapacity = length + 1 > 16 ? length + 1 : 16;
+        signal->text = malloc(signal->textCapacity);
+        if (!signal->text)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+    }
+    memcpy(signal->text, text, length);
+    signal->text[length] = '\0';
+    signal->changed = 1;
+
+    if (signal->kind == TABLE_REAL)
+    {
+        const double real = strtod(signal->text, NULL);
+        memcpy(&signal->value, &real, sizeof(real));
+        signal->unknown = 0;
+        return;
+    }
+    // Vectors are left-extended with 0, so the low 64 bits are the last 64 characters
+    uint64_t value = 0;
+    int unknown = 0;
+    for (size_t i = length > 64 ? length - 64 : 0; i < length; i++)
+    {
+        value = value << 1 | (text[i] == '1');
+        unknown |= text[i] != '0' && text[i] != '1';
+    }
+    for (size_t i = 0; i + 64 < length && !unknown; i++)
+    {
+        unknown = text[i] != '0' && text[i] != '1';
+    }
+    signal->value = value;
+    signal->unknown = unknown;
+}
+
+/*
+    Writes a CSV field, quoted if it contains a comma, quote or line break
+    parameters:
+        file: the CSV
+        text: the field
+    returns: -
+*/
+static void writeCsvField(FILE* file, const char* text)
+{
+    if (!strpbrk(text, ",\"\r\n"))
+    {
+        fputs(text, file);
+        return;
+    }
+    fputc('"', file);
+    for (const char* c = text; *c; c++)
+    {
+        if (*c == '"')
+        {
+            fputc('"', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+/*
+    Formats an unsigned integer in decimal
+    parameters:
+        value: the integer
+        out: receives the digits and a terminating null, at least 21 bytes
+    returns: -
+*/
+static void formatDecimal(uint64_t value, char* out)
+{
+    char digits[20];
+    unsigned count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+    for (unsigned i = 0; i < count; i++)
+    {
+        out[i] = digits[count - 1 - i];
+    }
+    out[count] = '\0';
+}
+
+/*
+    Writes the header of the table
+    parameters:
+        table: the table, its columns set
+        timescale: timescale of the VCD, e.g. "1 ns"
+    returns: 0 on success, -1 if it could not be written
+*/
+static int writeHeader(struct Table* table, const char* timescale)
+{
+    if (!table->binary)
+    {
+        // "time in ns" for a timescale of 1 ns, the magnitude is only named if it is not 1
+        const char* unit = strncmp(timescale, "1 ", 2) == 0 ? timescale + 2 : timescale;
+        fprintf(table->file, "time in %s", unit);
+        for (unsigned i = 0; i < table->numColumns; i++)
+        {
+            fputc(',', table->file);
+            writeCsvField(table->file, table->columns[i]->reference);
+        }
+        fputc('\n', table->file);
+        return ferror(table->file) ? -1 : 0;
+    }
+
+    uint8_t header[24] = {0};
+    memcpy(header, TABLE_MAGIC, 4);
+    header[4] = TABLE_VERSION;
+    storeLittleEndian(header + 8, table->numColumns, 4);
+    int failed = fwrite(header, 1, sizeof(header), table->file) != sizeof(header);
+    uint8_t length[2];
+    storeLittleEndian(length, strlen(timescale), 2);
+    failed |= fwrite(length, 1, 2, table->file) != 2;
+    failed |= fwrite(timescale, 1, strlen(timescale), table->file) != strlen(timescale);
+    for (unsigned i = 0; i < table->numColumns; i++)
+    {
+        const struct Signal* signal = table->columns[i];
+        const size_t nameLength = strlen(signal->name) < UINT16_MAX ? strlen(signal->name) : UINT16_MAX;
+        uint8_t column[6] = {0};
+        storeLittleEndian(column, signal->width < UINT16_MAX ? signal->width : UINT16_MAX, 2);
+        column[2] = (uint8_t)signal->kind;
+        storeLittleEndian(column + 4, nameLength, 2);
+        failed |= fwrite(column, 1, sizeof(column), table->file) != sizeof(column);
+        failed |= fwrite(signal->name, 1, nameLength, table->file) != nameLength;
+    }
+    return failed ? -1 : 0;
+}
+
+/*
+    Writes the rows of the binary block collected so far
+    parameters:
+        table: the table
+    returns: 0 on success, -1 if it could not be written
+*/
+static int flushBlock(struct Table* table)
+{
+    const unsigned rows = table->blockRows;
+    const size_t bitmapBytes = (rows + 7) / 8;
+    uint8_t* out = table->encoded;
+    storeLittleEndian(out, rows, 4);
+    out += 4;
+    for (unsigned r = 0; r < rows; r++, out += 8)
+    {
+        storeLittleEndian(out, table->times[r], 8);
+    }
+    for (unsigned c = 0; c < table->numColumns; c++)
+    {
+        memcpy(out, table->changed + (size_t)c * (TABLE_BLOCK_ROWS / 8), bitmapBytes);
+        out += bitmapBytes;
+        memcpy(out, table->unknown + (size_t)c * (TABLE_BLOCK_ROWS / 8), bitmapBytes);
+        out += bitmapBytes;
+        const uint64_t* values = table->values + (size_t)c * TABLE_BLOCK_ROWS;
+        for (unsigned r = 0; r < rows; r++, out += 8)
+        {
+            storeLittleEndian(out, values[r], 8);
+        }
+    }
+    const size_t size = (size_t)(out - table->encoded);
+    table->blockRows = 0;
+    memset(table->changed, 0, (size_t)table->numColumns * (TABLE_BLOCK_ROWS / 8));
+    memset(table->unknown, 0, (size_t)table->numColumns * (TABLE_BLOCK_ROWS / 8));
+    return fwrite(table->encoded, 1, size, table->file) == size ? 0 : -1;
+}
+
+/*
+    Writes the row of a time step and clears the changes of the signals
+    parameters:
+        table: the table
+        time: time of the row
+    returns: 0 on success, -1 if it could not be written
+*/
+static int writeRow(struct Table* table, uint64_t time)
+{
+    table->numRows++;
+    if (table->binary)
+    {
+        const unsigned r = table->blockRows++;
+        table->times[r] = time;
+        for (unsigned c = 0; c < table->numColumns; c++)
+        {
+            struct Signal* signal = table->columns[c];
+            table->values[(size_t)c * TABLE_BLOCK_ROWS + r] = signal->value;
+            table->changed[(size_t)c * (TABLE_BLOCK_ROWS / 8) + r / 8] |= (uint8_t)(signal->changed << (r % 8));
+            table->unknown[(size_t)c * (TABLE_BLOCK_ROWS / 8) + r / 8] |= (uint8_t)(signal->unknown << (r % 8));
+            signal->changed = 0;
+        }
+        return table->blockRows == TABLE_BLOCK_ROWS ? flushBlock(table) : 0;
+    }
+
+    char number[21];
+    formatDecimal(time, number);
+    fputs(number, table->file);
+    for (unsigned c = 0; c < table->numColumns; c++)
+    {
+        struct Signal* signal = table->columns[c];
+        fputc(',', table->file);
+        if ((signal->changed || table->hold) && signal->text)
+        {
+            // Vectors in decimal as long as all their bits are known, the rest as they appear in the VCD
+            if (signal->kind == TABLE_VECTOR && signal->width > 1 && !signal->unknown && strlen(signal->text) <= 64)
+            {
+                formatDecimal(signal->value, number);
+                fputs(number, table->file);
+            }
+            else
+            {
+                writeCsvField(table->file, signal->text);
+            }
+        }
+        signal->changed = 0;
+    }
+    fputc('\n', table->file);
+    return ferror(table->file) ? -1 : 0;
+}
+
+/*
+    Whether a signal is named in the --signals list, by its name, its hierarchical name or the end of it starting at a
+    scope
+    parameters:
+        signal: the signal
+        names: the names
+        numNames: number of names
+        matched: flags of the names that matched a signal, updated
+    returns: 1 if it is selected
+*/
+static int isSelected(const struct Signal* signal, char** names, unsigned numNames, int* matched)
+{
+    int selected = 0;
+    for (unsigned i = 0; i < numNames; i++)
+    {
+        const size_t length = strlen(names[i]);
+        const size_t nameLength = strlen(signal->name);
+        if (strcmp(names[i], signal->reference) == 0 || strcmp(names[i], signal->name) == 0 ||
+            (length < nameLength && signal->name[nameLength - length - 1] == '.' &&
+             strcmp(signal->name + nameLength - length, names[i]) == 0))
+        {
+            matched[i] = 1;
+            selected = 1;
+        }
+    }
+    return selected;
+}
+
+/*
+    Finds the signal of an identifier code in the hash table built after the definitions
+    parameters:
+        slots: the hash table, indices into signals or -1
+        mask: size of the table - 1
+        signals: the signals
+        id: identifier code
+    returns: the signal, NULL if no signal has this code
+*/
+static struct Signal* findSignal(const int* slots, size_t mask, struct Signal* signals, const char* id)
+{
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (const char* c = id; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 1099511628211ull;
+    }
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        if (slots[slot] < 0 || strcmp(signals[slots[slot]].id, id) == 0)
+        {
+            return slots[slot] < 0 ? NULL : &signals[slots[slot]];
+        }
+    }
+}
+
+/*
+    Inserts a signal into the hash table of identifier codes
+    parameters:
+        slots: the hash table, indices into signals or -1
+        mask: size of the table - 1
+        signals: the signals
+        index: index of the signal to insert
+    returns: index of the signal that already has this code, -1 if there is none
+*/
+static int insertSignal(int* slots, size_t mask, const struct Signal* signals, int index)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* c = signals[index].id; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 1099511628211ull;
+    }
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        if (slots[slot] < 0)
+        {
+            slots[slot] = index;
+            return -1;
+        }
+        if (strcmp(signals[slots[slot]].id, signals[index].id) == 0)
+        {
+            return slots[slot];
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int binary = 0;
+    int hold = 0;
+    uint64_t every = 0; // Time units per row, 0 = a row per time step
+    char* signalList = NULL;
+
+    static struct option long_options[] = {
+        {"format", required_argument, 0, 'f'},
+        {"signals", required_argument, 0, 's'},
+        {"every", required_argument, 0, 'e'},
+        {"hold", no_argument, 0, 'o'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int opt;
+
+    // Parameter handling
+    while ((opt = getopt_long(argc, argv, "h", long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+        case 'h': //--help
+            {
+                fprintf(stderr, "Usage: %s [options] <vcd file> [<output file>]\n", argv[0]);
+                fprintf(stderr, "Options:\n");
+                fprintf(stderr, "  --format <format>          Write a csv or binary table (default csv)\n");
+                fprintf(stderr, "  --signals <name,...>       Only tabulate these signals, by name or by\n");
+                fprintf(stderr, "                             hierarchical name (scope.name, leading scopes may\n");
+                fprintf(stderr, "                             be left out)\n");
+                fprintf(stderr, "  --every <time>             Downsample to one row per this many time units, each\n");
+                fprintf(stderr, "                             with the last change of every signal in its window\n");
+                fprintf(stderr, "  --hold                     Fill the csv cells of signals that did not change\n");
+                fprintf(stderr, "                             with the value they hold\n");
+                fprintf(stderr, "  <vcd file>                 Positional Argument: Set the input file path, -\n");
+                fprintf(stderr, "                             reads standard input\n");
+                fprintf(stderr, "  <output file>              Positional Argument: Set the output file path, -\n");
+                fprintf(stderr, "                             writes standard output (default %s or\n",
+                        DEFAULT_CSV);
+                fprintf(stderr, "                             %s)\n", DEFAULT_BINARY);
+                fprintf(stderr, "  -h, --help                 Display this help and exit\n");
+                return 0;
+            }
+        case 'f': //--format <format>
+            {
+                if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "binary") != 0)
+                {
+                    fprintf(stderr, "Unknown format (csv, binary): %s\n", optarg);
+                    return 1;
+                }
+                binary = strcmp(optarg, "binary") == 0;
+                break;
+            }
+        case 's': //--signals <name,...>
+            {
+                signalList = optarg;
+                break;
+            }
+        case 'e': //--every <time>
+            {
+                if (toUnsigned64(optarg, UINT64_MAX, &every) != 0 || every == 0)
+                {
+                    fprintf(stderr, "Invalid downsampling interval: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+        case 'o': //--hold
+            {
+                hold = 1;
+                break;
+            }
+        default:
+            fprintf(stderr, "Unknown option: %s\n", argv[optind - 1]);
+            fprintf(stderr, "Use -h or --help for displaying valid options.\n");
+            return 1;
+        }
+    }
+
+    if (optind >= argc || argc - optind > 2)
+    {
+        fprintf(stderr, "Please give a VCD file and optionally an output file, -h or --help lists the options\n");
+        return 1;
+    }
+    if (hold && binary)
+    {
+        fprintf(stderr, "--hold applies to csv tables, the binary format always holds the values\n");
+        return 1;
+    }
+
+    // The names of --signals
+    char** names = NULL;
+    int* matched = NULL;
+    unsigned numNames = 0;
+    if (signalList)
+    {
+        names = malloc((strlen(signalList) / 2 + 1) * sizeof(char*));
+        matched = calloc(strlen(signalList) / 2 + 1, sizeof(int));
+        if (!names || !matched)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            return 1;
+        }
+        char* save = NULL;
+        for (char* name = strtok_r(signalList, ",", &save); name; name = strtok_r(NULL, ",", &save))
+        {
+            names[numNames++] = name;
+        }
+    }
+
+    const char* inputPath = argv[optind];
+    const char* outputPath = optind + 1 < argc ? argv[optind + 1] : binary ? DEFAULT_BINARY : DEFAULT_CSV;
+    struct Reader reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.file = strcmp(inputPath, "-") == 0 ? stdin : fopen(inputPath, "rb");
+    if (!reader.file)
+    {
+        fprintf(stderr, "Error opening file: %s\n", inputPath);
+        return 1;
+    }
+    reader.buffer = malloc(READ_BUFFER);
+    reader.capacity = 64;
+    reader.token = malloc(reader.capacity);
+    reader.heldCapacity = 64;
+    reader.held = malloc(reader.heldCapacity);
+    if (!reader.buffer || !reader.token || !reader.held)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    // Definitions: timescale, scopes and signals
+    struct Signal* signals = NULL;
+    size_t numSignals = 0;
+    size_t signalCapacity = 0;
+    char scope[4096] = "";
+    size_t scopeLengths[256];
+    unsigned depth = 0;
+    char timescale[64] = "1 s";
+    int failed = 0;
+    int defined = 0;
+    while (!failed && !defined && nextToken(&reader))
+    {
+        if (strcmp(reader.token, "$timescale") == 0)
+        {
+            // "1 ns" or "1ns", the magnitude and the unit are written apart
+            size_t length = 0;
+            while (!(failed = !nextToken(&reader)) && strcmp(reader.token, "$end") != 0)
+            {
+                const size_t split = strspn(reader.token, "0123456789");
+                length += (size_t)snprintf(timescale + length, sizeof(timescale) - length, "%s%.*s%s%s",
+                                           length ? " " : "", (int)split, reader.token,
+                                           split && reader.token[split] ? " " : "", reader.token + split);
+                length = length < sizeof(timescale) ? length : sizeof(timescale) - 1;
+            }
+        }
+        else if (strcmp(reader.token, "$scope") == 0)
+        {
+            failed = !nextToken(&reader) || !nextToken(&reader) || depth == 256;
+            if (!failed)
+            {
+                scopeLengths[depth++] = strlen(scope);
+                snprintf(scope + strlen(scope), sizeof(scope) - strlen(scope), "%s.", reader.token);
+                failed = skipToEnd(&reader) != 0;
+            }
+        }
+        else if (strcmp(reader.token, "$upscope") == 0)
+        {
+            failed = depth == 0 || skipToEnd(&reader) != 0;
+            if (!failed)
+            {
+                scope[scopeLengths[--depth]] = '\0';
+            }
+        }
+        else if (strcmp(reader.token, "$var") == 0)
+        {
+            if (numSignals == signalCapacity)
+            {
+                signalCapacity = signalCapacity ? 2 * signalCapacity : 64;
+                signals = realloc(signals, signalCapacity * sizeof(struct Signal));
+                if (!signals)
+                {
+                    fprintf(stderr, "Memory allocation failed\n");
+                    return 1;
+                }
+            }
+            // $var <type> <width> <id> <reference> [<bit range>] $end
+            struct Signal* signal = &signals[numSignals];
+            memset(signal, 0, sizeof(*signal));
+            failed = !nextToken(&reader);
+            signal->kind = !failed && strncmp(reader.token, "real", 4) == 0 ? TABLE_REAL : TABLE_VECTOR;
+            failed = failed || !nextToken(&reader);
+            signal->width = failed ? 0 : (unsigned)strtoul(reader.token, NULL, 10);
+            failed = failed || !nextToken(&reader);
+            signal->id = failed ? NULL : copyString(reader.token, reader.length);
+            failed = failed || !nextToken(&reader);
+            if (!failed)
+            {
+                const size_t scopeLength = strlen(scope);
+                signal->name = malloc(scopeLength + reader.length + 1);
+                if (!signal->name)
+                {
+                    fprintf(stderr, "Memory allocation failed\n");
+                    return 1;
+                }
+                memcpy(signal->name, scope, scopeLength);
+                memcpy(signal->name + scopeLength, reader.token, reader.length + 1);
+                signal->reference = signal->name + scopeLength;
+                signal->unknown = 1;
+                numSignals++;
+                failed = skipToEnd(&reader) != 0;
+            }
+        }
+        else if (strcmp(reader.token, "$enddefinitions") == 0)
+        {
+            failed = skipToEnd(&reader) != 0;
+            defined = 1;
+        }
+        else if (reader.token[0] == '$') // $date, $version, $comment
+        {
+            failed = skipToEnd(&reader) != 0;
+        }
+        else
+        {
+            fprintf(stderr, "Unexpected token in the definitions: %s\n", reader.token);
+            return 1;
+        }
+    }
+    if (failed || !defined)
+    {
+        fprintf(stderr, "Incomplete VCD definitions: %s\n", inputPath);
+        return 1;
+    }
+
+    // Identifier codes in a hash table, a signal declared in several scopes keeps its first declaration
+    size_t slotCount = 16;
+    while (slotCount < 2 * numSignals)
+    {
+        slotCount *= 2;
+    }
+    int* slots = malloc(slotCount * sizeof(int));
+    struct Table table;
+    memset(&table, 0, sizeof(table));
+    table.columns = malloc((numSignals + 1) * sizeof(struct Signal*));
+    if (!slots || !table.columns)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    memset(slots, 0xff, slotCount * sizeof(int));
+    for (size_t i = 0; i < numSignals; i++)
+    {
+        const int first = insertSignal(slots, slotCount - 1, signals, (int)i);
+        signals[i].column = -1;
+        if (first >= 0)
+        {
+            // An alias is selected if any of its names is
+            const int selected = names && isSelected(&signals[i], names, numNames, matched);
+            if (selected && signals[first].column < 0)
+            {
+                signals[first].column = (int)table.numColumns;
+                table.columns[table.numColumns++] = &signals[first];
+            }
+            continue;
+        }
+        if (!names || isSelected(&signals[i], names, numNames, matched))
+        {
+            signals[i].column = (int)table.numColumns;
+            table.columns[table.numColumns++] = &signals[i];
+        }
+    }
+    for (unsigned i = 0; i < numNames; i++)
+    {
+        if (!matched[i])
+        {
+            fprintf(stderr, "No signal named %s\n", names[i]);
+            return 1;
+        }
+    }
+
+    table.file = strcmp(outputPath, "-") == 0 ? stdout : fopen(outputPath, "wb");
+    if (!table.file)
+    {
+        fprintf(stderr, "Error creating file: %s\n", outputPath);
+        return 1;
+    }
+    table.binary = binary;
+    table.hold = hold;
+    if (binary)
+    {
+        const size_t columns = table.numColumns ? table.numColumns : 1;
+        table.times = malloc(TABLE_BLOCK_ROWS * sizeof(uint64_t));
+        table.values = malloc(columns * TABLE_BLOCK_ROWS * sizeof(uint64_t));
+        table.changed = calloc(columns, TABLE_BLOCK_ROWS / 8);
+        table.unknown = calloc(columns, TABLE_BLOCK_ROWS / 8);
+        table.encoded = malloc(4 + (columns + 1) * (TABLE_BLOCK_ROWS * 8 + TABLE_BLOCK_ROWS / 4));
+        if (!table.times || !table.values || !table.changed || !table.unknown || !table.encoded)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            return 1;
+        }
+    }
+    failed = writeHeader(&table, timescale) != 0;
+
+    // Value changes, a row is written once the next time step (or window of --every) starts
+    uint64_t time = 0; // Time of the pending row
+    int pending = 0; // A selected signal changed since the last row
+    size_t changes = 0;
+    while (!failed && nextToken(&reader))
+    {
+        const char kind = reader.token[0];
+        if (kind == '#')
+        {
+            uint64_t next = strtoull(reader.token + 1, NULL, 10);
+            next = every ? next - next % every : next;
+            if (pending && next != time)
+            {
+                failed = writeRow(&table, time) != 0;
+                pending = 0;
+            }
+            time = next;
+            continue;
+        }
+        if (kind == '$') // $dumpvars, $dumpall, $dumpon, $dumpoff and their $end list ordinary changes
+        {
+            if (strcmp(reader.token, "$comment") == 0)
+            {
+                failed = skipToEnd(&reader) != 0;
+            }
+            continue;
+        }
+
+        // Scalars carry their identifier code in the same token, vectors and reals in the next one
+        const char* id = reader.token + 1;
+        const char scalar = (char)(kind >= 'A' && kind <= 'Z' ? kind - 'A' + 'a' : kind);
+        const char* value = &scalar;
+        size_t length = 1;
+        if (kind == 'b' || kind == 'B' || kind == 'r' || kind == 'R')
+        {
+            length = reader.length - 1;
+            holdToken(&reader);
+            if (!nextToken(&reader))
+            {
+                fprintf(stderr, "Value change without identifier code at the end of %s\n", inputPath);
+                failed = 1;
+                break;
+            }
+            value = reader.held + 1;
+            id = reader.token;
+        }
+        struct Signal* signal = findSignal(slots, slotCount - 1, signals, id);
+        if (!signal)
+        {
+            fprintf(stderr, "Value change of an undeclared signal: %s\n", id);
+            failed = 1;
+            break;
+        }
+        if (signal->column >= 0)
+        {
+            changeSignal(signal, value, length);
+            pending = 1;
+            changes++;
+        }
+    }
+    if (!failed && pending)
+    {
+        failed = writeRow(&table, time) != 0;
+    }
+    if (!failed && binary && table.blockRows != 0)
+    {
+        failed = flushBlock(&table) != 0;
+    }
+    if (!failed && binary && fseek(table.file, 16, SEEK_SET) == 0) // The number of rows, unless writing to a pipe
+    {
+        uint8_t rows[8];
+        storeLittleEndian(rows, table.numRows, 8);
+        failed = fwrite(rows, 1, sizeof(rows), table.file) != sizeof(rows);
+    }
+    const int toStdout = table.file == stdout;
+    failed = (toStdout ? fflush(table.file) : fclose(table.file)) != 0 || failed || ferror(reader.file);
+    if (failed)
+    {
+        fprintf(stderr, "Error converting %s to %s\n", inputPath, outputPath);
+    }
+    else
+    {
+        fprintf(toStdout ? stderr : stdout, "Wrote %llu rows of %u signals (%zu changes) to %s\n",
+                (unsigned long long)table.numRows, table.numColumns, changes, outputPath);
+    }
+
+    if (reader.file != stdin)
+    {
+        fclose(reader.file);
+    }
+    for (size_t i = 0; i < numSignals; i++)
+    {
+        free(signals[i].id);
+        free(signals[i].name);
+        free(signals[i].text);
+    }
+    free(signals);
+    free(slots);
+    free(table.columns);
+    free(table.times);
+    free(table.values);
+    free(table.changed);
+    free(table.unknown);
+    free(table.encoded);
+    free(reader.buffer);
+    free(reader.token);
+    free(reader.held);
+    free(names);
+    free(matched);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "binary_trace.h"
+#include "parallel.h"
+#include "workloads.h"
+
+#define JOB_REQUESTS BINARY_TRACE_BLOCK // Requests a thread generates at a time, one block of a binary trace
+#define MAX_LINE_LENGTH 24 // "W,0x", 8 hex digits, ",", 10 decimal digits and the newline
+
+// Range of the trace generated and formatted by one thread, the jobs of a round cover consecutive ranges
+struct Job
+{
+    const Workload* workload;
+    uint64_t first;
+    size_t count;
+    int binary;
+    unsigned flags; // Flags of the binary trace
+    struct Request* requests;
+    char* text; // CSV lines of the requests
+    size_t textSize;
+    BinaryTraceBlock* block; // Encoded requests of a binary trace
+    int failed;
+};
+
+int toUnsigned64(const char* optarg, uint64_t max, uint64_t* result)
+{
+    char* endptr;
+    unsigned long long val;
+
+    errno = 0;
+    val = strtoull(optarg, &endptr, 0); // Decimal, or hexadecimal with 0x
+    if (errno != 0 || endptr == optarg || *endptr != '\0' || strchr(optarg, '-') || val > max)
+    {
+        return -1;
+    }
+    *result = (uint64_t)val;
+    return 0;
+}
+
+int toWorkloadKernel(const char* optarg, int* result)
+{
+    static const char* const names[] = {
+        "matmul-ijk", "matmul-ikj", "matmul-tiled", "stencil-2d", "stencil-3d", "stream", "chase", "uniform", "zipfian"
+    };
+    static const int kernels[] = {
+        WORKLOAD_MATMUL_IJK, WORKLOAD_MATMUL_IKJ, WORKLOAD_MATMUL_TILED, WORKLOAD_STENCIL_2D, WORKLOAD_STENCIL_3D,
+        WORKLOAD_STREAM, WORKLOAD_CHASE, WORKLOAD_UNIFORM, WORKLOAD_ZIPFIAN
+    };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (strcmp(optarg, names[i]) == 0)
+        {
+            *result = kernels[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+    Formats a request as a line of a csv trace
+    parameters:
+        line: where the line goes, room for MAX_LINE_LENGTH characters
+        request: the request
+    returns: the first character after the line
+*/
+static char* formatRequest(char* line, const struct Request* request)
+{
+    static const char digits[] = "0123456789abcdef";
+    *line++ = request->we ? 'W' : 'R';
+    *line++ = ',';
+    *line++ = '0';
+    *line++ = 'x';
+    int shift = 28;
+    while (shift > 0 && (request->addr >> shift) == 0)
+    {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4)
+    {
+        *line++ = digits[(request->addr >> shift) & 0xf];
+    }
+    *line++ = ',';
+    if (request->we)
+    {
+        char reversed[10];
+        int length = 0;
+        uint32_t value = request->data;
+        do
+        {
+            reversed[length++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (length > 0)
+        {
+            *line++ = reversed[--length];
+        }
+    }
+    *line++ = '\n';
+    return line;
+}
+
+/*
+    Generates the requests of a job and formats or encodes them
+    parameters:
+        arg: the job
+    returns: NULL
+*/
+static void* runJob(void* arg)
+{
+    struct Job* job = arg;
+    generateRequests(job->workload, job->first, job->count, job->requests);
+    if (job->binary)
+    {
+        job->failed = encodeBinaryTraceBlock(job->block, job->requests, job->count, job->flags) != 0;
+    }
+    else
+    {
+        char* end = job->text;
+        for (size_t i = 0; i < job->count; i++)
+        {
+            end = formatRequest(end, &job->requests[i]);
+        }
+        job->textSize = (size_t)(end - job->text);
+    }
+    return NULL;
+}
+
+/*
+    Hands the next ranges of the trace to a set of jobs and starts them, each on its own thread
+    parameters:
+        jobs: the set of jobs
+        numJobs: number of jobs in the set
+        threads: receives the threads of the jobs, room for numJobs
+        numThreads: receives the number of threads started, to join with joinJobs
+        next: first request not handed out yet, advanced
+        total: number of requests of the trace
+    returns: number of jobs started, 0 once the whole trace was handed out
+*/
+static size_t startRound(struct Job* jobs, size_t numJobs, pthread_t* threads, size_t* numThreads, uint64_t* next,
+                         uint64_t total)
+{
+    size_t started = 0;
+    for (; started < numJobs && *next < total; started++)
+    {
+        struct Job* job = &jobs[started];
+        job->first = *next;
+        job->count = total - *next < JOB_REQUESTS ? (size_t)(total - *next) : JOB_REQUESTS;
+        *next += job->count;
+    }
+    *numThreads = startJobs(jobs, started, sizeof(struct Job), runJob, threads);
+    return started;
+}
+
+/*
+    Writes the output of the jobs of a round in order
+    parameters:
+        jobs: the set of jobs
+        numJobs: number of jobs started
+        file: the trace
+        bytes: number of bytes written so far, advanced
+    returns: 0 on success, -1 if a job failed or the trace could not be written
+*/
+static int writeRound(const struct Job* jobs, size_t numJobs, FILE* file, uint64_t* bytes)
+{
+    for (size_t i = 0; i < numJobs; i++)
+    {
+        size_t size = jobs[i].textSize;
+        if (jobs[i].failed || (jobs[i].binary ? (size = writeBinaryTraceBlock(jobs[i].block, file)) == 0
+                                              : fwrite(jobs[i].text, 1, size, file) != size))
+        {
+            return -1;
+        }
+        *bytes += size;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Workload workload;
+    memset(&workload, 0, sizeof(workload));
+    workload.kernel = -1;
+    workload.size = 64;
+    workload.stride = 4;
+    workload.tile = 16;
+    workload.base = 0x1000;
+    workload.seed = 1;
+    workload.writes = 30;
+    workload.skew = 0.99;
+    uint64_t numRequests = 0; // 0 = one pass
+    int binary = 0;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t numJobs = processors > 0 ? (size_t)processors : 1;
+
+    static struct option long_options[] = {
+        {"workload", required_argument, 0, 'w'},
+        {"size", required_argument, 0, 's'},
+        {"stride", required_argument, 0, 'd'},
+        {"tile", required_argument, 0, 't'},
+        {"base", required_argument, 0, 'b'},
+        {"seed", required_argument, 0, 'e'},
+        {"requests", required_argument, 0, 'n'},
+        {"writes", required_argument, 0, 'r'},
+        {"skew", required_argument, 0, 'k'},
+        {"format", required_argument, 0, 'f'},
+        {"jobs", required_argument, 0, 'j'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int opt;
+    uint64_t number_input;
+
+    // Parameter handling
+    while ((opt = getopt_long(argc, argv, "h", long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+        case 'h': //--help
+            {
+                fprintf(stderr, "Usage: %s --workload <workload> [options] <filename>\n", argv[0]);
+                fprintf(stderr, "Options:\n");
+                fprintf(stderr, "  --workload <workload>      Kernel to trace: matmul-ijk, matmul-ikj,\n");
+                fprintf(stderr, "                             matmul-tiled, stencil-2d, stencil-3d, stream, chase,\n");
+                fprintf(stderr, "                             uniform, zipfian\n");
+                fprintf(stderr, "  --size <number>            Matrix or grid side, number of elements or nodes of\n");
+                fprintf(stderr, "                             the other workloads (default 64)\n");
+                fprintf(stderr, "  --stride <bytes>           Distance between consecutive elements (default 4)\n");
+                fprintf(stderr, "  --tile <number>            Tile side of matmul-tiled, divides --size\n");
+                fprintf(stderr, "                             (default 16)\n");
+                fprintf(stderr, "  --base <address>           Address of the first array (default 0x1000)\n");
+                fprintf(stderr, "  --seed <number>            Seed of chase, uniform and zipfian (default 1)\n");
+                fprintf(stderr, "  --requests <number>        Length of the trace, the kernels repeat (default one\n");
+                fprintf(stderr, "                             pass, --size requests for chase, uniform, zipfian)\n");
+                fprintf(stderr, "  --writes <percent>         Share of writes of uniform and zipfian (default 30)\n");
+                fprintf(stderr, "  --skew <exponent>          Zipf exponent of zipfian, in (0, 1) (default 0.99)\n");
+                fprintf(stderr, "  --format <format>          Write a csv or binary trace (default csv)\n");
+                fprintf(stderr, "  --jobs <number>            Number of generating threads (default: all cores)\n");
+                fprintf(stderr, "  <filename>                 Positional Argument: Set the output file path, -\n");
+                fprintf(stderr, "                             writes standard output\n");
+                fprintf(stderr, "  -h, --help                 Display this help and exit\n");
+                return 0;
+            }
+        case 'w': //--workload <workload>
+            {
+                if (toWorkloadKernel(optarg, &workload.kernel) != 0)
+                {
+                    fprintf(stderr, "Unknown workload: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+        case 's': //--size <number>
+        case 'd': //--stride <bytes>
+        case 't': //--tile <number>
+        case 'b': //--base <address>
+            {
+                if (toUnsigned64(optarg, UINT32_MAX, &number_input) != 0)
+                {
+                    fprintf(stderr, "Invalid value for --%s: %s\n", long_options[option_index].name, optarg);
+                    return 1;
+                }
+                uint32_t* value = opt == 's' ? &workload.size : opt == 'd' ? &workload.stride
+                                : opt == 't' ? &workload.tile : &workload.base;
+                *value = (uint32_t)number_input;
+                break;
+            }
+        case 'e': //--seed <number>
+            {
+                if (toUnsigned64(optarg, UINT64_MAX, &workload.seed) != 0)
+                {
+                    fprintf(stderr, "Invalid seed: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+        case 'n': //--requests <number>
+            {
+                if (toUnsigned64(optarg, UINT64_MAX, &numRequests) != 0 || numRequests == 0)
+                {
+                    fprintf(stderr, "Invalid number of requests: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+        case 'r': //--writes <percent>
+            {
+                if (toUnsigned64(optarg, 100, &number_input) != 0)
+                {
+                    fprintf(stderr, "Invalid percentage of writes (0 to 100): %s\n", optarg);
+                    return 1;
+                }
+                workload.writes = (unsigned)number_input;
+                break;
+            }
+        case 'k': //--skew <exponent>
+            {
+                char* endptr;
+                workload.skew = strtod(optarg, &endptr);
+                if (endptr == optarg || *endptr != '\0')
+                {
+                    fprintf(stderr, "Invalid skew: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+        case 'f': //--format <format>
+            {
+                if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "binary") != 0)
+                {
+                    fprintf(stderr, "Unknown format (csv, binary): %s\n", optarg);
+                    return 1;
+                }
+                binary = strcmp(optarg, "binary") == 0;
+                break;
+            }
+        case 'j': //--jobs <number>
+            {
+                if (toUnsigned64(optarg, 1024, &number_input) != 0 || number_input == 0)
+                {
+                    fprintf(stderr, "Invalid number of jobs (1 to 1024): %s\n", optarg);
+                    return 1;
+                }
+                numJobs = (size_t)number_input;
+                break;
+            }
+        default:
+            fprintf(stderr, "Unknown option: %s\n", argv[optind - 1]);
+            fprintf(stderr, "Use -h or --help for displaying valid options.\n");
+            return 1;
+        }
+    }
+
+    if (workload.kernel < 0 || optind >= argc)
+    {
+        fprintf(stderr, "Please choose a --workload and an output file, -h or --help lists the options\n");
+        return 1;
+    }
+    if (initWorkload(&workload) != 0)
+    {
+        return 1;
+    }
+    if (numRequests == 0)
+    {
+        numRequests = workload.period;
+    }
+
+    const char* outputPath = argv[optind];
+    FILE* output = strcmp(outputPath, "-") == 0 ? stdout : fopen(outputPath, "wb");
+    if (!output)
+    {
+        fprintf(stderr, "Error creating file: %s\n", outputPath);
+        deleteWorkload(&workload);
+        return 1;
+    }
+
+    // Two sets of jobs, one generating while the output of the other is written
+    struct Job* sets[2];
+    sets[0] = calloc(2 * numJobs, sizeof(struct Job));
+    sets[1] = sets[0] ? sets[0] + numJobs : NULL;
+    pthread_t* threads[2];
+    threads[0] = malloc(2 * numJobs * sizeof(pthread_t));
+    threads[1] = threads[0] ? threads[0] + numJobs : NULL;
+    int failed = !sets[0] || !threads[0];
+    const unsigned flags = workload.kernel != WORKLOAD_CHASE ? BINARY_TRACE_VALUES : 0;
+    for (size_t i = 0; i < 2 * numJobs && !failed; i++)
+    {
+        struct Job* job = &sets[0][i];
+        job->workload = &workload;
+        job->binary = binary;
+        job->flags = flags;
+        job->requests = malloc(JOB_REQUESTS * sizeof(struct Request));
+        job->text = binary ? NULL : malloc(JOB_REQUESTS * MAX_LINE_LENGTH);
+        job->block = binary ? createBinaryTraceBlock() : NULL;
+        failed = !job->requests || (binary ? !job->block : !job->text);
+    }
+    if (failed)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+    }
+
+    uint64_t bytes = 0;
+    if (!failed)
+    {
+        static const char header[] = "Type,Address,Value\n";
+        failed = binary ? writeBinaryTraceHeader(output, flags, numRequests) != 0
+                        : fwrite(header, 1, sizeof(header) - 1, output) != sizeof(header) - 1;
+        bytes = binary ? BINARY_TRACE_HEADER_SIZE : sizeof(header) - 1;
+    }
+
+    uint64_t next = 0;
+    size_t started[2] = {0, 0};
+    size_t numThreads[2] = {0, 0};
+    unsigned current = 0;
+    if (!failed)
+    {
+        started[0] = startRound(sets[0], numJobs, threads[0], &numThreads[0], &next, numRequests);
+    }
+    while (started[current] != 0)
+    {
+        joinJobs(threads[current], numThreads[current]);
+        started[current ^ 1] = failed ? 0
+                                      : startRound(sets[current ^ 1], numJobs, threads[current ^ 1],
+                                                   &numThreads[current ^ 1], &next, numRequests);
+        failed = failed || writeRound(sets[current], started[current], output, &bytes) != 0;
+        started[current] = 0;
+        current ^= 1;
+    }
+    const int toStdout = output == stdout;
+    failed = (toStdout ? fflush(output) : fclose(output)) != 0 || failed;
+    if (failed)
+    {
+        fprintf(stderr, "Error writing file: %s\n", outputPath);
+    }
+    else
+    {
+        // The summary must not end up in a trace written to standard output
+        fprintf(toStdout ? stderr : stdout, "Wrote %llu requests to %s (%llu bytes)\n",
+                (unsigned long long)numRequests, outputPath, (unsigned long long)bytes);
+    }
+
+    for (size_t i = 0; sets[0] && i < 2 * numJobs; i++)
+    {
+        free(sets[0][i].requests);
+        free(sets[0][i].text);
+        deleteBinaryTraceBlock(sets[0][i].block);
+    }
+    free(sets[0]);
+    free(threads[0]);
+    deleteWorkload(&workload);
+    return failed ? 1 : 0;
+}
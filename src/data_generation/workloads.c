@@ -0,0 +1,468 @@
+#include "workloads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define ZETA_EXACT_TERMS (1u << 20) // Terms of the zeta sum added one by one, the rest is approximated
+#define WRITE_STREAM 0x5851f42d4c957f2dull // Seed offset of the random numbers deciding between reads and writes
+#define ORDER_STREAM 0x14057b7ef767814full // Seed offset of the random numbers shuffling the chase
+
+// Fills the requests [qBegin, qEnd) of one row of a pass
+typedef void (*RowFiller)(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                          struct Request* requests);
+
+/*
+    Counter based random number generator (splitmix64)
+    parameters:
+        seed: the seed
+        index: position in the sequence
+    returns: the random number
+*/
+static uint64_t mix(uint64_t seed, uint64_t index)
+{
+    uint64_t z = seed + (index + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/*
+    Scales a random number to [0, range)
+    parameters:
+        random: the random number
+        range: size of the range, at most 2^32
+    returns: the scaled number
+*/
+static uint64_t scale(uint64_t random, uint64_t range)
+{
+    return ((random >> 32) * range) >> 32;
+}
+
+/*
+    Computes the address of an element
+    parameters:
+        workload: the workload
+        array: number of the array
+        index: index of the element in the array
+    returns: the address
+*/
+static uint32_t address(const Workload* workload, unsigned array, uint64_t index)
+{
+    return (uint32_t)(workload->base + (array * workload->elements + index) * workload->stride);
+}
+
+/*
+    Stores a request
+    parameters:
+        request: where to store it
+        addr: its address
+        we: 1 for a write, 0 for a read
+        data: data of a write
+    returns: -
+*/
+static void setRequest(struct Request* request, uint32_t addr, int we, uint32_t data)
+{
+    request->addr = addr;
+    request->data = we ? data : 0;
+    request->we = (uint8_t)we;
+    request->core = 0;
+    request->reserved[0] = request->reserved[1] = 0;
+}
+
+/*
+    Sum of 1 / i^theta for i from 1 to n, the terms after ZETA_EXACT_TERMS by the Euler-Maclaurin formula
+    parameters:
+        n: number of terms
+        theta: the exponent
+    returns: the sum
+*/
+static double zeta(uint64_t n, double theta)
+{
+    const uint64_t exact = n < ZETA_EXACT_TERMS ? n : ZETA_EXACT_TERMS;
+    double sum = 0;
+    for (uint64_t i = exact; i >= 1; i--) // Smallest terms first
+    {
+        sum += pow((double)i, -theta);
+    }
+    if (n > exact)
+    {
+        const double m = (double)exact;
+        const double x = (double)n;
+        sum += (pow(x, 1 - theta) - pow(m, 1 - theta)) / (1 - theta) + (pow(x, -theta) - pow(m, -theta)) / 2 -
+               theta * (pow(x, -theta - 1) - pow(m, -theta - 1)) / 12;
+    }
+    return sum;
+}
+
+// Row (i, j): A[i][k] and B[k][j] for every k, then C[i][j]
+static void fillMatmulIjk(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                          struct Request* requests)
+{
+    (void)pass;
+    const uint64_t n = workload->size;
+    const uint64_t i = row / n;
+    const uint64_t j = row % n;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        if (q == 2 * n)
+        {
+            setRequest(requests, address(workload, 2, row), 1, (uint32_t)row);
+        }
+        else
+        {
+            const uint64_t k = q >> 1;
+            setRequest(requests, q & 1 ? address(workload, 1, k * n + j) : address(workload, 0, i * n + k), 0, 0);
+        }
+    }
+}
+
+/*
+    Fills part of the row of an ikj loop nest: A[i][k], then B[k][j], C[i][j] and the write of C[i][j] for every j of
+    the row
+    parameters:
+        workload: the workload
+        i, k: the row
+        jBegin: first j of the row
+        qBegin, qEnd: requests of the row to fill
+        requests: receives the requests
+    returns: -
+*/
+static void fillIkjRow(const Workload* workload, uint64_t i, uint64_t k, uint64_t jBegin, uint64_t qBegin,
+                       uint64_t qEnd, struct Request* requests)
+{
+    const uint64_t n = workload->size;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        if (q == 0)
+        {
+            setRequest(requests, address(workload, 0, i * n + k), 0, 0);
+            continue;
+        }
+        const uint64_t j = jBegin + (q - 1) / 3;
+        switch ((q - 1) % 3)
+        {
+        case 0:
+            setRequest(requests, address(workload, 1, k * n + j), 0, 0);
+            break;
+        case 1:
+            setRequest(requests, address(workload, 2, i * n + j), 0, 0);
+            break;
+        default:
+            setRequest(requests, address(workload, 2, i * n + j), 1, (uint32_t)(i * n + j));
+            break;
+        }
+    }
+}
+
+// Row (i, k) over all j
+static void fillMatmulIkj(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                          struct Request* requests)
+{
+    (void)pass;
+    fillIkjRow(workload, row / workload->size, row % workload->size, 0, qBegin, qEnd, requests);
+}
+
+// Tiles (ii, jj, kk) in row major order, within a tile row (i, k) over the j of the tile
+static void fillMatmulTiled(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                            struct Request* requests)
+{
+    (void)pass;
+    const uint64_t tile = workload->tile;
+    const uint64_t tiles = workload->size / tile; // Tiles per dimension
+    const uint64_t block = row / (tile * tile);
+    const uint64_t within = row % (tile * tile);
+    const uint64_t i = block / (tiles * tiles) * tile + within / tile;
+    const uint64_t k = block % tiles * tile + within % tile;
+    fillIkjRow(workload, i, k, block / tiles % tiles * tile, qBegin, qEnd, requests);
+}
+
+// Interior point (y, x): its four neighbours and itself from the input grid, then the output grid
+static void fillStencil2d(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                          struct Request* requests)
+{
+    static const int dy[] = {-1, 0, 0, 0, 1};
+    static const int dx[] = {0, -1, 0, 1, 0};
+    const uint64_t n = workload->size;
+    const uint64_t inner = n - 2;
+    const uint64_t center = (1 + row / inner) * n + 1 + row % inner;
+    const unsigned input = pass & 1; // The grids swap roles every pass
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        if (q == 5)
+        {
+            setRequest(requests, address(workload, input ^ 1, center), 1, (uint32_t)center);
+        }
+        else
+        {
+            setRequest(requests, address(workload, input, center + dy[q] * (int64_t)n + dx[q]), 0, 0);
+        }
+    }
+}
+
+// Interior point (z, y, x): its six neighbours and itself from the input grid, then the output grid
+static void fillStencil3d(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                          struct Request* requests)
+{
+    static const int dz[] = {-1, 0, 0, 0, 0, 0, 1};
+    static const int dy[] = {0, -1, 0, 0, 0, 1, 0};
+    static const int dx[] = {0, 0, -1, 0, 1, 0, 0};
+    const uint64_t n = workload->size;
+    const uint64_t inner = n - 2;
+    const uint64_t center = ((1 + row / (inner * inner)) * n + 1 + row / inner % inner) * n + 1 + row % inner;
+    const unsigned input = pass & 1;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        if (q == 7)
+        {
+            setRequest(requests, address(workload, input ^ 1, center), 1, (uint32_t)center);
+        }
+        else
+        {
+            const int64_t offset = (dz[q] * (int64_t)n + dy[q]) * (int64_t)n + dx[q];
+            setRequest(requests, address(workload, input, center + offset), 0, 0);
+        }
+    }
+}
+
+// Element i: a[i], then b[i]
+static void fillStream(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                       struct Request* requests)
+{
+    (void)pass;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        setRequest(requests, address(workload, (unsigned)q, row), q == 1, (uint32_t)row);
+    }
+}
+
+// One row per lap, the nodes in the order of the cycle
+static void fillChase(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                      struct Request* requests)
+{
+    (void)pass;
+    (void)row;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        setRequest(requests, address(workload, 0, workload->order[q]), 0, 0);
+    }
+}
+
+// One row per pass of size requests, each drawn on its own
+static void fillUniform(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                        struct Request* requests)
+{
+    (void)row;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        const uint64_t index = pass * workload->period + q;
+        const uint64_t element = scale(mix(workload->seed, index), workload->size);
+        const int we = scale(mix(workload->seed ^ WRITE_STREAM, index), 100) < workload->writes;
+        setRequest(requests, address(workload, 0, element), we, (uint32_t)element);
+    }
+}
+
+// Like fillUniform, the elements drawn as in "Quickly Generating Billion-Record Synthetic Databases" (Gray et al.)
+static void fillZipfian(const Workload* workload, uint64_t pass, uint64_t row, uint64_t qBegin, uint64_t qEnd,
+                        struct Request* requests)
+{
+    (void)row;
+    const uint64_t n = workload->size;
+    for (uint64_t q = qBegin; q < qEnd; q++, requests++)
+    {
+        const uint64_t index = pass * workload->period + q;
+        const double u = (double)(mix(workload->seed, index) >> 11) * 0x1.0p-53;
+        const double uz = u * workload->zetaN;
+        uint64_t element = uz < 1.0 ? 0
+                           : uz < workload->secondThreshold ? 1
+                           : (uint64_t)((double)n * pow(workload->eta * u - workload->eta + 1.0, workload->alpha));
+        if (element >= n)
+        {
+            element = n - 1;
+        }
+        const int we = scale(mix(workload->seed ^ WRITE_STREAM, index), 100) < workload->writes;
+        setRequest(requests, address(workload, 0, element), we, (uint32_t)element);
+    }
+}
+
+static const RowFiller rowFillers[] = {
+    fillMatmulIjk, fillMatmulIkj, fillMatmulTiled, fillStencil2d, fillStencil3d, fillStream, fillChase, fillUniform,
+    fillZipfian
+};
+
+/*
+    Checks the parameters of a workload and derives its pass length, chase order and distribution constants
+    parameters:
+        workload: the workload, its parameters filled in
+    returns: 0 on success, -1 with an error message if the parameters are invalid or the arrays exceed 32 bit
+             addresses
+*/
+int initWorkload(Workload* workload)
+{
+    const uint64_t n = workload->size;
+    unsigned dimensions = 1;
+    unsigned arrays = 1;
+    uint64_t minimum = 1;
+    workload->order = NULL;
+
+    switch (workload->kernel)
+    {
+    case WORKLOAD_MATMUL_IJK:
+        dimensions = 2;
+        arrays = 3;
+        workload->rowLength = 2 * n + 1;
+        workload->rows = n * n;
+        break;
+    case WORKLOAD_MATMUL_IKJ:
+        dimensions = 2;
+        arrays = 3;
+        workload->rowLength = 3 * n + 1;
+        workload->rows = n * n;
+        break;
+    case WORKLOAD_MATMUL_TILED:
+        if (workload->tile == 0 || n % workload->tile != 0)
+        {
+            fprintf(stderr, "--tile must divide --size\n");
+            return -1;
+        }
+        dimensions = 2;
+        arrays = 3;
+        workload->rowLength = 3 * (uint64_t)workload->tile + 1;
+        workload->rows = n * n * (n / workload->tile);
+        break;
+    case WORKLOAD_STENCIL_2D:
+        dimensions = 2;
+        arrays = 2;
+        minimum = 3;
+        workload->rowLength = 6;
+        workload->rows = (n - 2) * (n - 2);
+        break;
+    case WORKLOAD_STENCIL_3D:
+        dimensions = 3;
+        arrays = 2;
+        minimum = 3;
+        workload->rowLength = 8;
+        workload->rows = (n - 2) * (n - 2) * (n - 2);
+        break;
+    case WORKLOAD_STREAM:
+        arrays = 2;
+        workload->rowLength = 2;
+        workload->rows = n;
+        break;
+    case WORKLOAD_ZIPFIAN:
+        minimum = 2;
+        if (!(workload->skew > 0 && workload->skew < 1))
+        {
+            fprintf(stderr, "--skew must lie between 0 and 1 (exclusive)\n");
+            return -1;
+        }
+        // fall through
+    default:
+        workload->rowLength = n;
+        workload->rows = 1;
+        break;
+    }
+
+    if (n < minimum)
+    {
+        fprintf(stderr, "--size must be at least %llu for this workload\n", (unsigned long long)minimum);
+        return -1;
+    }
+    if (workload->stride == 0)
+    {
+        fprintf(stderr, "--stride must be positive\n");
+        return -1;
+    }
+    if (workload->writes > 100)
+    {
+        fprintf(stderr, "--writes is a percentage\n");
+        return -1;
+    }
+
+    // Every array has to fit into the address space above the base address
+    const uint64_t space = (1ull << 32) - workload->base;
+    uint64_t elements = 1;
+    for (unsigned d = 0; d < dimensions && elements <= space; d++)
+    {
+        elements *= n;
+    }
+    if (elements > space / arrays / workload->stride)
+    {
+        fprintf(stderr, "The %u arrays of the workload do not fit into the 32 bit addresses from --base on\n", arrays);
+        return -1;
+    }
+    workload->elements = elements;
+    workload->period = workload->rows * workload->rowLength;
+
+    if (workload->kernel == WORKLOAD_CHASE)
+    {
+        // Fisher-Yates shuffle, the chase visits the nodes in the shuffled order and starts over
+        workload->order = malloc(n * sizeof(uint32_t));
+        if (!workload->order)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            return -1;
+        }
+        for (uint64_t i = 0; i < n; i++)
+        {
+            workload->order[i] = (uint32_t)i;
+        }
+        for (uint64_t i = n - 1; i > 0; i--)
+        {
+            const uint64_t j = scale(mix(workload->seed ^ ORDER_STREAM, i), i + 1);
+            const uint32_t node = workload->order[i];
+            workload->order[i] = workload->order[j];
+            workload->order[j] = node;
+        }
+    }
+    else if (workload->kernel == WORKLOAD_ZIPFIAN)
+    {
+        const double theta = workload->skew;
+        workload->zetaN = zeta(n, theta);
+        workload->alpha = 1.0 / (1.0 - theta);
+        workload->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta(2, theta) / workload->zetaN);
+        workload->secondThreshold = 1.0 + pow(0.5, theta);
+    }
+    return 0;
+}
+
+/*
+    Releases what initWorkload allocated
+    parameters:
+        workload: the workload
+    returns: -
+*/
+void deleteWorkload(Workload* workload)
+{
+    free(workload->order);
+    workload->order = NULL;
+}
+
+/*
+    Generates a range of the sequence of a workload, safe to call from several threads at once
+    parameters:
+        workload: the initialized workload
+        first: index of the first request
+        count: number of requests
+        requests: receives the requests
+    returns: -
+*/
+void generateRequests(const Workload* workload, uint64_t first, size_t count, struct Request* requests)
+{
+    const RowFiller fill = rowFillers[workload->kernel];
+    uint64_t pass = first / workload->period;
+    uint64_t row = first % workload->period / workload->rowLength;
+    uint64_t q = first % workload->period % workload->rowLength;
+    while (count > 0)
+    {
+        const uint64_t end = workload->rowLength - q < count ? workload->rowLength : q + count;
+        fill(workload, pass, row, q, end, requests);
+        requests += end - q;
+        count -= end - q;
+        q = 0;
+        if (++row == workload->rows)
+        {
+            row = 0;
+            pass++;
+        }
+    }
+}
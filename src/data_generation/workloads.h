@@ -0,0 +1,85 @@
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "simulation.h"
+
+/*
+    Synthetic workloads.
+
+    Every workload is an endless sequence of requests in which any request can be computed from its index alone, so
+    the generator hands consecutive ranges of the sequence to different threads. The loop nests repeat after one pass
+    (the stencils swap their input and output grid on every pass), the random workloads draw each request from a
+    counter based generator seeded with the seed and the index.
+
+    The arrays of a workload lie back to back from the base address, element i of array a at
+    base + (a * elements + i) * stride. Writes store the index of the element they write.
+*/
+
+enum WorkloadKernel
+{
+    WORKLOAD_MATMUL_IJK, // C = A * B, the inner product of a row of A and a column of B per element of C
+    WORKLOAD_MATMUL_IKJ, // C += A[i][k] * B[k][:] row by row
+    WORKLOAD_MATMUL_TILED, // ikj on tile x tile blocks
+    WORKLOAD_STENCIL_2D, // 5 point Jacobi sweep over an n x n grid
+    WORKLOAD_STENCIL_3D, // 7 point Jacobi sweep over an n x n x n grid
+    WORKLOAD_STREAM, // b[i] = a[i]
+    WORKLOAD_CHASE, // Reads following a random cycle through n nodes
+    WORKLOAD_UNIFORM, // Uniformly random elements
+    WORKLOAD_ZIPFIAN // Zipf distributed elements, element 0 the hottest
+};
+
+typedef struct
+{
+    int kernel;
+    uint32_t size; // Matrix or grid side, number of elements for the one dimensional workloads
+    uint32_t stride; // Bytes between consecutive elements
+    uint32_t tile; // Tile side of WORKLOAD_MATMUL_TILED, divides size
+    uint32_t base; // Address of the first array
+    uint64_t seed;
+    unsigned writes; // Percentage of writes of WORKLOAD_UNIFORM and WORKLOAD_ZIPFIAN
+    double skew; // Zipf exponent of WORKLOAD_ZIPFIAN, between 0 and 1 (exclusive)
+
+    // Set by initWorkload
+    uint64_t rowLength; // Requests of the innermost loop (of the whole pass for the one dimensional workloads)
+    uint64_t rows; // Rows per pass
+    uint64_t period; // Requests of one pass, rows * rowLength
+    uint64_t elements; // Elements per array
+    uint32_t* order; // Nodes of WORKLOAD_CHASE in the order they are visited
+    double zetaN; // Constants of WORKLOAD_ZIPFIAN
+    double eta;
+    double alpha;
+    double secondThreshold;
+} Workload;
+
+/*
+    Checks the parameters of a workload and derives its pass length, chase order and distribution constants
+    parameters:
+        workload: the workload, its parameters filled in
+    returns: 0 on success, -1 with an error message if the parameters are invalid or the arrays exceed 32 bit
+             addresses
+*/
+int initWorkload(Workload* workload);
+
+/*
+    Releases what initWorkload allocated
+    parameters:
+        workload: the workload
+    returns: -
+*/
+void deleteWorkload(Workload* workload);
+
+/*
+    Generates a range of the sequence of a workload, safe to call from several threads at once
+    parameters:
+        workload: the initialized workload
+        first: index of the first request
+        count: number of requests
+        requests: receives the requests
+    returns: -
+*/
+void generateRequests(const Workload* workload, uint64_t first, size_t count, struct Request* requests);
+
+#endif // WORKLOADS_H
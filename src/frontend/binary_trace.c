@@ -0,0 +1,525 @@
+#include "binary_trace.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BLOCK_HEADER_SIZE 20
+#define MAX_VARINT_SIZE 5 // Bytes of the longest varint of a 32 bit value
+
+// Growing byte buffer holding one stream of a block
+struct Stream
+{
+    uint8_t* bytes;
+    size_t size;
+    size_t capacity;
+};
+
+// Block encoder, the streams of one block before they are written
+struct BinaryTraceBlock
+{
+    struct Stream streams[4]; // Type, address, value and core stream
+    uint32_t numRequests;
+};
+
+// Block of the mapped file and the requests it decodes into
+struct Block
+{
+    const uint8_t* streams; // First byte after the block header
+    uint32_t numRequests;
+    uint32_t sizes[4]; // Byte sizes of the type, address, value and core streams
+    struct Request* requests;
+};
+
+// Range of blocks decoded by one thread
+struct DecodeJob
+{
+    struct Block* blocks;
+    size_t first;
+    size_t last;
+    unsigned flags;
+    size_t corruptBlock; // First block that failed to decode, or SIZE_MAX
+};
+
+/*
+    Stores a little endian integer
+    parameters:
+        bytes: where to store it
+        value: the integer
+        size: number of bytes
+    returns: -
+*/
+static void storeLittleEndian(uint8_t* bytes, uint64_t value, unsigned size)
+{
+    for (unsigned i = 0; i < size; i++)
+    {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/*
+    Loads a little endian integer
+    parameters:
+        bytes: where it is stored
+        size: number of bytes
+    returns: the integer
+*/
+static uint64_t loadLittleEndian(const uint8_t* bytes, unsigned size)
+{
+    uint64_t value = 0;
+    for (unsigned i = 0; i < size; i++)
+    {
+        value |= (uint64_t)bytes[i] << (8 * i);
+    }
+    return value;
+}
+
+/*
+    Appends a varint to a stream
+    parameters:
+        stream: the stream
+        value: the value
+    returns: 0 on success, -1 if the stream could not grow
+*/
+static int putVarint(struct Stream* stream, uint32_t value)
+{
+    if (stream->size + MAX_VARINT_SIZE > stream->capacity)
+    {
+        size_t capacity = stream->capacity ? stream->capacity * 2 : 4096;
+        uint8_t* bytes = realloc(stream->bytes, capacity);
+        if (!bytes)
+        {
+            return -1;
+        }
+        stream->bytes = bytes;
+        stream->capacity = capacity;
+    }
+    while (value >= 0x80)
+    {
+        stream->bytes[stream->size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    stream->bytes[stream->size++] = (uint8_t)value;
+    return 0;
+}
+
+/*
+    Reads a varint from a stream
+    parameters:
+        pos: where the varint starts, set to the first byte after it
+        end: end of the stream
+        value: receives the value
+    returns: 0 on success, -1 if the varint runs past the end of the stream or 32 bits
+*/
+static int getVarint(const uint8_t** pos, const uint8_t* end, uint32_t* value)
+{
+    const uint8_t* p = *pos;
+    uint32_t result = 0;
+    for (unsigned shift = 0; shift < 7 * MAX_VARINT_SIZE && p < end; shift += 7)
+    {
+        uint8_t byte = *p++;
+        result |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            *pos = p;
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+    Checks whether a file starts with the magic of a binary trace
+    parameters:
+        path: path to the file
+    returns: 1 if it is a binary trace, 0 otherwise (also if it cannot be read)
+*/
+int isBinaryTrace(const char* path)
+{
+    char magic[4];
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return 0;
+    }
+    int binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, BINARY_TRACE_MAGIC, 4) == 0;
+    fclose(file);
+    return binary;
+}
+
+/*
+    Writes the file header of a binary trace
+    parameters:
+        file: the file, positioned at its start
+        flags: BINARY_TRACE_VALUES and BINARY_TRACE_CORES as they apply to the requests
+        numRequests: number of requests the blocks will hold
+    returns: 0 on success, -1 if it could not be written
+*/
+int writeBinaryTraceHeader(FILE* file, unsigned flags, size_t numRequests)
+{
+    uint8_t header[BINARY_TRACE_HEADER_SIZE] = {0};
+    memcpy(header, BINARY_TRACE_MAGIC, 4);
+    header[4] = BINARY_TRACE_VERSION;
+    header[5] = (uint8_t)flags;
+    storeLittleEndian(header + 8, numRequests, 8);
+    storeLittleEndian(header + 16, BINARY_TRACE_BLOCK, 4);
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) ? 0 : -1;
+}
+
+/*
+    Creates an empty block encoder
+    parameters: -
+    returns: the encoder, NULL if it could not be allocated
+*/
+BinaryTraceBlock* createBinaryTraceBlock(void)
+{
+    return calloc(1, sizeof(BinaryTraceBlock));
+}
+
+/*
+    Deletes a block encoder
+    parameters:
+        block: the encoder (may be NULL)
+    returns: -
+*/
+void deleteBinaryTraceBlock(BinaryTraceBlock* block)
+{
+    if (block)
+    {
+        for (unsigned s = 0; s < 4; s++)
+        {
+            free(block->streams[s].bytes);
+        }
+        free(block);
+    }
+}
+
+/*
+    Encodes requests into a block, replacing what the encoder held before
+    parameters:
+        block: the encoder
+        requests: the requests of the block
+        count: number of requests, at most BINARY_TRACE_BLOCK
+        flags: flags of the trace
+    returns: 0 on success, -1 if the streams could not grow
+*/
+int encodeBinaryTraceBlock(BinaryTraceBlock* block, const struct Request* requests, size_t count, unsigned flags)
+{
+    struct Stream* streams = block->streams;
+    for (unsigned s = 0; s < 4; s++)
+    {
+        streams[s].size = 0;
+    }
+
+    // Bit-packed types
+    size_t typeBytes = (count + 7) / 8;
+    if (typeBytes > streams[0].capacity)
+    {
+        uint8_t* bytes = realloc(streams[0].bytes, typeBytes);
+        if (!bytes)
+        {
+            return -1;
+        }
+        streams[0].bytes = bytes;
+        streams[0].capacity = typeBytes;
+    }
+    if (typeBytes != 0)
+    {
+        memset(streams[0].bytes, 0, typeBytes);
+    }
+    streams[0].size = typeBytes;
+
+    int failed = 0;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < count && !failed; i++)
+    {
+        const struct Request* request = &requests[i];
+        uint32_t delta = request->addr - previous;
+        previous = request->addr;
+        streams[0].bytes[i / 8] |= (uint8_t)((request->we ? 1 : 0) << (i % 8));
+        failed |= putVarint(&streams[1], delta << 1 ^ (0u - (delta >> 31))) != 0;
+        if ((flags & BINARY_TRACE_VALUES) && request->we)
+        {
+            failed |= putVarint(&streams[2], request->data) != 0;
+        }
+        if (flags & BINARY_TRACE_CORES)
+        {
+            failed |= putVarint(&streams[3], request->core) != 0;
+        }
+    }
+    block->numRequests = (uint32_t)count;
+    return failed ? -1 : 0;
+}
+
+/*
+    Appends an encoded block to a binary trace, after the header and the blocks before it
+    parameters:
+        block: the encoder holding the block
+        file: the file
+    returns: number of bytes written, 0 if it could not be written
+*/
+size_t writeBinaryTraceBlock(const BinaryTraceBlock* block, FILE* file)
+{
+    uint8_t blockHeader[BLOCK_HEADER_SIZE];
+    size_t size = sizeof(blockHeader);
+    storeLittleEndian(blockHeader, block->numRequests, 4);
+    for (unsigned s = 0; s < 4; s++)
+    {
+        storeLittleEndian(blockHeader + 4 + 4 * s, block->streams[s].size, 4);
+        size += block->streams[s].size;
+    }
+    int failed = fwrite(blockHeader, 1, sizeof(blockHeader), file) != sizeof(blockHeader);
+    for (unsigned s = 0; s < 4 && !failed; s++)
+    {
+        if (block->streams[s].size != 0) // Streams left out have no buffer
+        {
+            failed |= fwrite(block->streams[s].bytes, 1, block->streams[s].size, file) != block->streams[s].size;
+        }
+    }
+    return failed ? 0 : size;
+}
+
+/*
+    Writes requests as a binary trace, the value and core streams are left out if every write stores 0 or every
+    request runs on core 0
+    parameters:
+        path: path to the file to create
+        requests: the requests
+        numRequests: number of requests
+    returns: size of the file in bytes, 0 if it could not be written
+*/
+size_t writeBinaryTrace(const char* path, const struct Request* requests, size_t numRequests)
+{
+    unsigned flags = 0;
+    for (size_t i = 0; i < numRequests; i++)
+    {
+        flags |= (requests[i].we && requests[i].data != 0 ? BINARY_TRACE_VALUES : 0)
+                 | (requests[i].core != 0 ? BINARY_TRACE_CORES : 0);
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Error creating file: %s\n", path);
+        return 0;
+    }
+    BinaryTraceBlock* block = createBinaryTraceBlock();
+    int failed = !block || writeBinaryTraceHeader(file, flags, numRequests) != 0;
+    size_t fileSize = BINARY_TRACE_HEADER_SIZE;
+    for (size_t first = 0; first < numRequests && !failed; first += BINARY_TRACE_BLOCK)
+    {
+        size_t count = numRequests - first < BINARY_TRACE_BLOCK ? numRequests - first : BINARY_TRACE_BLOCK;
+        size_t size = 0;
+        failed |= encodeBinaryTraceBlock(block, requests + first, count, flags) != 0 ||
+                  (size = writeBinaryTraceBlock(block, file)) == 0;
+        fileSize += size;
+    }
+
+    deleteBinaryTraceBlock(block);
+    failed |= fclose(file) != 0;
+    if (failed)
+    {
+        fprintf(stderr, "Error writing file: %s\n", path);
+        return 0;
+    }
+    return fileSize;
+}
+
+/*
+    Decodes one block into its requests
+    parameters:
+        block: the block
+        flags: flags of the trace
+    returns: 0 on success, -1 if the block is malformed
+*/
+static int decodeBlock(const struct Block* block, unsigned flags)
+{
+    const uint8_t* types = block->streams;
+    const uint8_t* addrs = types + block->sizes[0];
+    const uint8_t* addrsEnd = addrs + block->sizes[1];
+    const uint8_t* values = addrsEnd;
+    const uint8_t* valuesEnd = values + block->sizes[2];
+    const uint8_t* cores = valuesEnd;
+    const uint8_t* coresEnd = cores + block->sizes[3];
+    if (block->sizes[0] != (block->numRequests + 7) / 8)
+    {
+        return -1;
+    }
+
+    uint32_t previous = 0;
+    for (uint32_t i = 0; i < block->numRequests; i++)
+    {
+        struct Request* request = &block->requests[i];
+        uint32_t zigzag;
+        if (getVarint(&addrs, addrsEnd, &zigzag) != 0)
+        {
+            return -1;
+        }
+        previous += zigzag >> 1 ^ (0u - (zigzag & 1));
+        request->addr = previous;
+        request->we = (types[i / 8] >> (i % 8)) & 1;
+        request->data = 0;
+        request->core = 0;
+        request->reserved[0] = request->reserved[1] = 0;
+        if ((flags & BINARY_TRACE_VALUES) && request->we && getVarint(&values, valuesEnd, &request->data) != 0)
+        {
+            return -1;
+        }
+        if (flags & BINARY_TRACE_CORES)
+        {
+            uint32_t core;
+            if (getVarint(&cores, coresEnd, &core) != 0 || core >= MAX_CORES)
+            {
+                return -1;
+            }
+            request->core = (uint8_t)core;
+        }
+    }
+    return addrs == addrsEnd && values == valuesEnd && cores == coresEnd ? 0 : -1;
+}
+
+/*
+    Decodes a range of blocks, stopping at the first malformed one
+    parameters:
+        arg: the decode job
+    returns: NULL
+*/
+static void* decodeBlocks(void* arg)
+{
+    struct DecodeJob* job = arg;
+    for (size_t i = job->first; i < job->last; i++)
+    {
+        if (decodeBlock(&job->blocks[i], job->flags) != 0)
+        {
+            job->corruptBlock = i;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*
+    Reads a binary trace, the blocks are decoded in parallel straight into the request array
+    parameters:
+        path: path to the file
+        numRequests pointer to where the number of requests will be stored
+        requests pointer to where the array of requests will be stored
+    returns: - (exits with an error message if the file cannot be read or is malformed)
+*/
+void readBinaryTrace(const char* path, size_t* numRequests, struct Request** requests)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || (size_t)info.st_size < BINARY_TRACE_HEADER_SIZE)
+    {
+        fprintf(stderr, "Error opening file: %s\n", path);
+        exit(1);
+    }
+    size_t size = (size_t)info.st_size;
+    const uint8_t* file = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED)
+    {
+        fprintf(stderr, "Error mapping file: %s\n", path);
+        exit(1);
+    }
+    posix_madvise((void*)file, size, POSIX_MADV_SEQUENTIAL);
+
+    unsigned flags = file[5];
+    uint64_t requestCount = loadLittleEndian(file + 8, 8);
+    uint64_t blockSize = loadLittleEndian(file + 16, 4);
+    if (memcmp(file, BINARY_TRACE_MAGIC, 4) != 0 || file[4] != BINARY_TRACE_VERSION || blockSize == 0 ||
+        requestCount > SIZE_MAX / sizeof(struct Request))
+    {
+        fprintf(stderr, "Unsupported binary trace: %s\n", path);
+        exit(1);
+    }
+
+    // Walk the block headers, which places every block in the file and in the request array
+    size_t numBlocks = (size_t)((requestCount + blockSize - 1) / blockSize);
+    struct Block* blocks = malloc((numBlocks ? numBlocks : 1) * sizeof(struct Block));
+    struct Request* requestArray = requestCount ? malloc((size_t)requestCount * sizeof(struct Request)) : NULL;
+    if (!blocks || (requestCount && !requestArray))
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    const uint8_t* pos = file + BINARY_TRACE_HEADER_SIZE;
+    const uint8_t* end = file + size;
+    size_t decoded = 0;
+    for (size_t i = 0; i < numBlocks; i++)
+    {
+        struct Block* block = &blocks[i];
+        uint64_t streamBytes = 0;
+        if ((size_t)(end - pos) < BLOCK_HEADER_SIZE)
+        {
+            fprintf(stderr, "Truncated binary trace in block %zu: %s\n", i, path);
+            exit(1);
+        }
+        block->numRequests = (uint32_t)loadLittleEndian(pos, 4);
+        for (unsigned s = 0; s < 4; s++)
+        {
+            block->sizes[s] = (uint32_t)loadLittleEndian(pos + 4 + 4 * s, 4);
+            streamBytes += block->sizes[s];
+        }
+        block->streams = pos + BLOCK_HEADER_SIZE;
+        block->requests = requestArray + decoded;
+        if (block->numRequests > blockSize || block->numRequests > requestCount - decoded ||
+            streamBytes > (size_t)(end - block->streams))
+        {
+            fprintf(stderr, "Truncated binary trace in block %zu: %s\n", i, path);
+            exit(1);
+        }
+        decoded += block->numRequests;
+        pos = block->streams + streamBytes;
+    }
+    if (decoded != requestCount)
+    {
+        fprintf(stderr, "Truncated binary trace, %zu of %zu requests: %s\n", decoded, (size_t)requestCount, path);
+        exit(1);
+    }
+
+    // One contiguous range of blocks per processor
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t numJobs = processors > 0 ? (size_t)processors : 1;
+    numJobs = numJobs < numBlocks ? numJobs : (numBlocks ? numBlocks : 1);
+    struct DecodeJob* jobs = calloc(numJobs, sizeof(struct DecodeJob));
+    if (!jobs)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (size_t j = 0; j < numJobs; j++)
+    {
+        jobs[j].blocks = blocks;
+        jobs[j].first = numBlocks * j / numJobs;
+        jobs[j].last = numBlocks * (j + 1) / numJobs;
+        jobs[j].flags = flags;
+        jobs[j].corruptBlock = SIZE_MAX;
+    }
+    runJobs(jobs, numJobs, sizeof(struct DecodeJob), decodeBlocks);
+    for (size_t j = 0; j < numJobs; j++)
+    {
+        if (jobs[j].corruptBlock != SIZE_MAX)
+        {
+            fprintf(stderr, "Corrupt binary trace in block %zu: %s\n", jobs[j].corruptBlock, path);
+            exit(1);
+        }
+    }
+
+#ifdef DEBUG
+    printf("Decoded %zu requests in %zu blocks\n", decoded, numBlocks);
+#endif
+
+    free(jobs);
+    free(blocks);
+    munmap((void*)file, size);
+
+    *numRequests = decoded;
+    *requests = requestArray;
+}
@@ -0,0 +1,112 @@
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "simulation.h"
+
+/*
+    Binary trace format, all integers little endian:
+
+    File header (24 bytes):
+        magic "CSTB", version (u8), flags (u8, BINARY_TRACE_VALUES / BINARY_TRACE_CORES), reserved (u16),
+        number of requests (u64), requests per block (u32), reserved (u32)
+
+    Then the blocks, each holding up to the requests per block and decodable on its own:
+        block header: number of requests, then the byte sizes of the type, address, value and core streams (5 x u32)
+        type stream: one bit per request, set for a write, least significant bit first
+        address stream: per request the difference to the previous address of the block (the first one to 0) as a
+                        zigzag varint
+        value stream: per write its data as a varint, absent without BINARY_TRACE_VALUES (the writes then store 0)
+        core stream: per request its core as a varint, absent without BINARY_TRACE_CORES (all requests on core 0)
+
+    A varint stores 7 bits per byte, least significant group first, the high bit marks that another byte follows.
+*/
+
+#define BINARY_TRACE_MAGIC "CSTB"
+#define BINARY_TRACE_VERSION 1
+#define BINARY_TRACE_HEADER_SIZE 24
+#define BINARY_TRACE_VALUES 0x1 // The writes carry their data
+#define BINARY_TRACE_CORES 0x2 // The requests carry their core
+#define BINARY_TRACE_BLOCK 65536 // Requests per block written by the converter
+
+// Encodes one block at a time, so traces can be written in blocks encoded on several threads
+typedef struct BinaryTraceBlock BinaryTraceBlock;
+
+/*
+    Checks whether a file starts with the magic of a binary trace
+    parameters:
+        path: path to the file
+    returns: 1 if it is a binary trace, 0 otherwise (also if it cannot be read)
+*/
+int isBinaryTrace(const char* path);
+
+/*
+    Writes requests as a binary trace, the value and core streams are left out if every write stores 0 or every
+    request runs on core 0
+    parameters:
+        path: path to the file to create
+        requests: the requests
+        numRequests: number of requests
+    returns: size of the file in bytes, 0 if it could not be written
+*/
+size_t writeBinaryTrace(const char* path, const struct Request* requests, size_t numRequests);
+
+/*
+    Writes the file header of a binary trace
+    parameters:
+        file: the file, positioned at its start
+        flags: BINARY_TRACE_VALUES and BINARY_TRACE_CORES as they apply to the requests
+        numRequests: number of requests the blocks will hold
+    returns: 0 on success, -1 if it could not be written
+*/
+int writeBinaryTraceHeader(FILE* file, unsigned flags, size_t numRequests);
+
+/*
+    Creates an empty block encoder
+    parameters: -
+    returns: the encoder, NULL if it could not be allocated
+*/
+BinaryTraceBlock* createBinaryTraceBlock(void);
+
+/*
+    Deletes a block encoder
+    parameters:
+        block: the encoder (may be NULL)
+    returns: -
+*/
+void deleteBinaryTraceBlock(BinaryTraceBlock* block);
+
+/*
+    Encodes requests into a block, replacing what the encoder held before
+    parameters:
+        block: the encoder
+        requests: the requests of the block
+        count: number of requests, at most BINARY_TRACE_BLOCK
+        flags: flags of the trace
+    returns: 0 on success, -1 if the streams could not grow
+*/
+int encodeBinaryTraceBlock(BinaryTraceBlock* block, const struct Request* requests, size_t count, unsigned flags);
+
+/*
+    Appends an encoded block to a binary trace, after the header and the blocks before it
+    parameters:
+        block: the encoder holding the block
+        file: the file
+    returns: number of bytes written, 0 if it could not be written
+*/
+size_t writeBinaryTraceBlock(const BinaryTraceBlock* block, FILE* file);
+
+/*
+    Reads a binary trace, the blocks are decoded in parallel straight into the request array
+    parameters:
+        path: path to the file
+        numRequests pointer to where the number of requests will be stored
+        requests pointer to where the array of requests will be stored
+    returns: - (exits with an error message if the file cannot be read or is malformed)
+*/
+void readBinaryTrace(const char* path, size_t* numRequests, struct Request** requests);
+
+#endif // BINARY_TRACE_H
@@ -0,0 +1,211 @@
+#include "event_log.h"
+#include "record_file.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EVENT_LOG_MAGIC "CSEV"
+#define EVENT_LOG_VERSION 1
+#define EXPORT_CHUNK 4096 // Events read from a log at a time
+
+// Header of an event log, the events follow it
+struct EventLogHeader
+{
+    struct RecordFileHeader common; // Records are struct Event
+    uint64_t numEvents;
+    uint64_t reserved;
+};
+
+_Static_assert(sizeof(struct EventLogHeader) == 32, "the event log header has a fixed layout");
+_Static_assert(sizeof(struct Event) == 32, "event log records have a fixed layout");
+
+// Signals of the exported VCD, in the order of their identifier characters starting at '!'
+enum VcdSignal
+{
+    VCD_REQUEST,
+    VCD_ADDR,
+    VCD_WE,
+    VCD_HIT,
+    VCD_LEVEL,
+    VCD_LATENCY,
+    VCD_EVICTION,
+    VCD_EVICTED,
+    VCD_SIGNALS
+};
+
+static const char* const vcdNames[VCD_SIGNALS] = {
+    "request", "addr", "we", "hit", "level", "latency", "eviction", "evicted"
+};
+static const unsigned vcdWidths[VCD_SIGNALS] = {64, 32, 1, 1, 8, 32, 1, 32};
+
+/*
+    Creates an event log and writes its header
+    parameters:
+        path: path to the file to create, NULL for a temporary file removed when it is closed
+    returns: the log positioned after its header, to be set as SimulationConfig.eventLog, NULL with an error message
+             if it cannot be created
+*/
+FILE* openEventLog(const char* path)
+{
+    FILE* log = path ? fopen(path, "w+b") : tmpfile();
+    if (!log)
+    {
+        fprintf(stderr, "Error creating file: %s\n", path ? path : "temporary event log");
+        return NULL;
+    }
+    struct EventLogHeader header;
+    memset(&header, 0, sizeof(header));
+    initRecordFileHeader(&header.common, EVENT_LOG_MAGIC, EVENT_LOG_VERSION, sizeof(struct Event));
+    if (fwrite(&header, sizeof(header), 1, log) != 1)
+    {
+        fprintf(stderr, "Error writing file: %s\n", path ? path : "temporary event log");
+        fclose(log);
+        return NULL;
+    }
+    return log;
+}
+
+/*
+    Stores the number of events in the header of a log once the simulation has written them
+    parameters:
+        log: the log
+        numEvents: number of events the simulation wrote (Result.loggedEvents)
+    returns: 0 on success, -1 with an error message if the log could not be written
+*/
+int finishEventLog(FILE* log, size_t numEvents)
+{
+    const uint64_t count = numEvents;
+    if (ferror(log) || fseek(log, offsetof(struct EventLogHeader, numEvents), SEEK_SET) != 0 ||
+        fwrite(&count, sizeof(count), 1, log) != 1 || fflush(log) != 0)
+    {
+        fprintf(stderr, "Error writing the event log\n");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+    Checks whether a file starts with the magic of an event log
+    parameters:
+        path: path to the file
+    returns: 1 if it is an event log, 0 otherwise (also if it cannot be read)
+*/
+int isEventLog(const char* path)
+{
+    return hasRecordFileMagic(path, EVENT_LOG_MAGIC);
+}
+
+/*
+    Writes the value of a VCD signal that changed
+    parameters:
+        vcd: the VCD
+        signal: the signal (enum VcdSignal)
+        value: its new value, the low vcdWidths[signal] bits are written
+    returns: -
+*/
+static void writeVcdValue(FILE* vcd, unsigned signal, uint64_t value)
+{
+    const char id = (char)('!' + signal);
+    if (vcdWidths[signal] == 1)
+    {
+        fprintf(vcd, "%c%c\n", value ? '1' : '0', id);
+        return;
+    }
+    char bits[65];
+    unsigned length = 0;
+    for (unsigned bit = vcdWidths[signal]; bit-- > 0;) // Leading zeros are left out
+    {
+        if (length != 0 || (value >> bit) & 1 || bit == 0)
+        {
+            bits[length++] = (char)('0' + ((value >> bit) & 1));
+        }
+    }
+    bits[length] = '\0';
+    fprintf(vcd, "b%s %c\n", bits, id);
+}
+
+/*
+    Writes the events of a finished log as a VCD, a time step of 1 ns per cycle like the signal trace of the SystemC
+    engine, every event at the cycle its request started in
+    parameters:
+        log: the log, read from its start
+        vcdPath: path to the VCD to create
+        numEvents: receives the number of events exported
+    returns: 0 on success, -1 with an error message if the log is invalid or the VCD cannot be written
+*/
+int exportEventLogVcd(FILE* log, const char* vcdPath, size_t* numEvents)
+{
+    struct EventLogHeader header;
+    if (fseek(log, 0, SEEK_SET) != 0 || fread(&header, sizeof(header), 1, log) != 1 ||
+        checkRecordFileHeader(&header.common, EVENT_LOG_MAGIC, EVENT_LOG_VERSION, sizeof(struct Event)) != 0)
+    {
+        fprintf(stderr, "Not an event log of this build\n");
+        return -1;
+    }
+    FILE* vcd = fopen(vcdPath, "w");
+    struct Event* events = malloc(EXPORT_CHUNK * sizeof(struct Event));
+    if (!vcd || !events)
+    {
+        fprintf(stderr, "Error creating file: %s\n", vcdPath);
+        if (vcd)
+        {
+            fclose(vcd);
+        }
+        free(events);
+        return -1;
+    }
+
+    fprintf(vcd, "$version cache simulation event log $end\n$timescale 1 ns $end\n$scope module events $end\n");
+    for (unsigned signal = 0; signal < VCD_SIGNALS; signal++)
+    {
+        fprintf(vcd, "$var wire %u %c %s $end\n", vcdWidths[signal], '!' + signal, vcdNames[signal]);
+    }
+    fprintf(vcd, "$upscope $end\n$enddefinitions $end\n");
+
+    // Only the signals that changed are written, the first event writes all of them
+    uint64_t previous[VCD_SIGNALS];
+    uint64_t time = 0;
+    size_t exported = 0;
+    size_t count;
+    while ((count = fread(events, sizeof(struct Event), EXPORT_CHUNK, log)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const struct Event* event = &events[i];
+            // Time never goes back in a VCD, events of several threads that were logged out of order keep the last
+            if (exported == 0 || event->cycle > time)
+            {
+                time = event->cycle;
+                fprintf(vcd, "#%llu\n", (unsigned long long)time);
+            }
+            const uint64_t values[VCD_SIGNALS] = {
+                event->request, event->addr, event->we, event->level == 0, (uint8_t)event->level, event->latency,
+                (event->flags & EVENT_EVICTION) != 0, event->evicted
+            };
+            for (unsigned signal = 0; signal < VCD_SIGNALS; signal++)
+            {
+                if (exported == 0 || values[signal] != previous[signal])
+                {
+                    writeVcdValue(vcd, signal, values[signal]);
+                    previous[signal] = values[signal];
+                }
+            }
+            exported++;
+        }
+    }
+    free(events);
+
+    int failed = ferror(log);
+    if (failed)
+    {
+        fprintf(stderr, "Error reading the event log\n");
+    }
+    if (ferror(vcd) | (fclose(vcd) != 0))
+    {
+        fprintf(stderr, "Error writing file: %s\n", vcdPath);
+        failed = 1;
+    }
+    *numEvents = exported;
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,55 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "simulation.h"
+
+/*
+    Binary event logs of simulation runs.
+
+    A log is a 32 byte header followed by one record per logged request, the record being struct Event exactly as it
+    is laid out in memory. The header identifies the layout (record size and byte order) and holds the number of
+    events, which is filled in once the run has finished. The simulation appends the records from a background
+    writer (see eventLog.h), a VCD of the events can be exported from a finished log.
+*/
+
+/*
+    Creates an event log and writes its header
+    parameters:
+        path: path to the file to create, NULL for a temporary file removed when it is closed
+    returns: the log positioned after its header, to be set as SimulationConfig.eventLog, NULL with an error message
+             if it cannot be created
+*/
+FILE* openEventLog(const char* path);
+
+/*
+    Stores the number of events in the header of a log once the simulation has written them
+    parameters:
+        log: the log
+        numEvents: number of events the simulation wrote (Result.loggedEvents)
+    returns: 0 on success, -1 with an error message if the log could not be written
+*/
+int finishEventLog(FILE* log, size_t numEvents);
+
+/*
+    Checks whether a file starts with the magic of an event log
+    parameters:
+        path: path to the file
+    returns: 1 if it is an event log, 0 otherwise (also if it cannot be read)
+*/
+int isEventLog(const char* path);
+
+/*
+    Writes the events of a finished log as a VCD, a time step of 1 ns per cycle like the signal trace of the SystemC
+    engine, every event at the cycle its request started in
+    parameters:
+        log: the log, read from its start
+        vcdPath: path to the VCD to create
+        numEvents: receives the number of events exported
+    returns: 0 on success, -1 with an error message if the log is invalid or the VCD cannot be written
+*/
+int exportEventLogVcd(FILE* log, const char* vcdPath, size_t* numEvents);
+
+#endif // EVENT_LOG_H
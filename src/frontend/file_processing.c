@@ -1,8 +1,29 @@
 #include "file_processing.h"
+#include "parallel.h"
+#include "simulation.h"
 #include <stdio.h>
 #include <string.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MIN_CHUNK_SIZE (1 << 20) // Smallest part of the file worth a thread of its own
+
+// Part of the file parsed by one thread, it starts at the beginning of a line and ends after a newline or at the end
+struct Chunk
+{
+    const char* begin;
+    const char* end;
+    size_t numLines; // Lines starting in the chunk
+    size_t firstLine; // Line number of the first line, counted from 1 for the header
+    Request* requests; // Where the requests of the chunk go, one per line
+    enum ParseError error; // First malformed line of the chunk, if any
+    size_t errorLine;
+    const char* errorText;
+};
 
 /*
     Creates a new FileProcessing object
@@ -30,7 +51,266 @@ void deleteFileProcessing(FileProcessing* fileProc)
 }
 
 /*
-    Gets the requests from the specified csv file
+    Reads a hexadecimal number with an optional 0x prefix
+    parameters:
+        pos: where the number starts, set to the first character after it
+        end: end of the line
+        value: receives the number
+    returns: PARSE_OK, PARSE_FORMAT if there is no digit or PARSE_RANGE if the number exceeds 32 bits
+*/
+static enum ParseError scanHex(const char** pos, const char* end, uint32_t* value)
+{
+    const char* p = *pos;
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        p += 2;
+    }
+    const char* digits = p;
+    uint64_t number = 0;
+    for (; p < end; p++)
+    {
+        unsigned digit;
+        if (*p >= '0' && *p <= '9')
+        {
+            digit = *p - '0';
+        }
+        else if ((*p | 0x20) >= 'a' && (*p | 0x20) <= 'f')
+        {
+            digit = (*p | 0x20) - 'a' + 10;
+        }
+        else
+        {
+            break;
+        }
+        number = number << 4 | digit;
+        if (number > UINT32_MAX)
+        {
+            return PARSE_RANGE;
+        }
+    }
+    if (p == digits)
+    {
+        return PARSE_FORMAT;
+    }
+    *pos = p;
+    *value = (uint32_t)number;
+    return PARSE_OK;
+}
+
+/*
+    Reads a decimal number
+    parameters:
+        pos: where the number starts, set to the first character after it
+        end: end of the line
+        limit: largest number allowed
+        value: receives the number
+    returns: PARSE_OK, PARSE_FORMAT if there is no digit or PARSE_RANGE if the number exceeds the limit
+*/
+static enum ParseError scanDecimal(const char** pos, const char* end, uint32_t limit, uint32_t* value)
+{
+    const char* p = *pos;
+    uint64_t number = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        number = number * 10 + (*p - '0');
+        if (number > limit)
+        {
+            return PARSE_RANGE;
+        }
+    }
+    if (p == *pos)
+    {
+        return PARSE_FORMAT;
+    }
+    *pos = p;
+    *value = (uint32_t)number;
+    return PARSE_OK;
+}
+
+/*
+    Parses one line of the trace: type (R or W), hexadecimal address, decimal data (empty for reads) and optionally
+    the core issuing the request
+    parameters:
+        line: first character of the line
+        end: end of the line, without the newline
+        request: receives the request
+    returns: PARSE_OK or what is wrong with the line
+*/
+enum ParseError parseRequestLine(const char* line, const char* end, Request* request)
+{
+    const char* p = line;
+    uint32_t addr;
+    uint32_t data = 0;
+    uint32_t core = 0;
+    enum ParseError error;
+
+    while (end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+    {
+        end--;
+    }
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    if (end - p < 3 || p[1] != ',')
+    {
+        return PARSE_FORMAT;
+    }
+    const char type = p[0];
+    p += 2;
+    if ((error = scanHex(&p, end, &addr)) != PARSE_OK)
+    {
+        return error;
+    }
+    if (p < end && *p++ != ',')
+    {
+        return PARSE_FORMAT;
+    }
+
+    //Data column, then the core column
+    const char* dataStart = p;
+    const char* dataEnd = memchr(p, ',', end - p);
+    if (dataEnd)
+    {
+        p = dataEnd + 1;
+        if (scanDecimal(&p, end, MAX_CORES - 1, &core) != PARSE_OK || p != end)
+        {
+            return PARSE_CORE;
+        }
+    }
+    else
+    {
+        dataEnd = end;
+    }
+
+    //Type = Write
+    if (type == 'W')
+    {
+        p = dataStart;
+        if ((error = scanDecimal(&p, dataEnd, UINT32_MAX, &data)) == PARSE_RANGE)
+        {
+            return PARSE_RANGE;
+        }
+        if (error != PARSE_OK || p != dataEnd)
+        {
+            return PARSE_WRITE;
+        }
+    } //Type = Read
+    else if (type == 'R')
+    {
+        if (dataStart != dataEnd)
+        {
+            // Throw error if data field is not empty
+            return PARSE_READ;
+        }
+    }
+    else
+    {
+        return PARSE_TYPE;
+    }
+
+    request->addr = addr;
+    request->data = data;
+    request->we = type == 'W';
+    request->core = (uint8_t)core;
+    request->reserved[0] = request->reserved[1] = 0;
+    return PARSE_OK;
+}
+
+/*
+    Counts the lines starting in a chunk
+    parameters:
+        arg: the chunk
+    returns: NULL
+*/
+static void* countLines(void* arg)
+{
+    struct Chunk* chunk = arg;
+    size_t lines = 0;
+    for (const char* p = chunk->begin; p < chunk->end; p++)
+    {
+        const char* newline = memchr(p, '\n', chunk->end - p);
+        lines++;
+        if (!newline)
+        {
+            break;
+        }
+        p = newline;
+    }
+    chunk->numLines = lines;
+    return NULL;
+}
+
+/*
+    Parses the lines of a chunk into its requests, stopping at the first malformed line
+    parameters:
+        arg: the chunk
+    returns: NULL
+*/
+static void* parseChunk(void* arg)
+{
+    struct Chunk* chunk = arg;
+    const char* line = chunk->begin;
+    for (size_t i = 0; i < chunk->numLines; i++)
+    {
+        const char* newline = memchr(line, '\n', chunk->end - line);
+        const char* end = newline ? newline : chunk->end;
+        enum ParseError error = parseRequestLine(line, end, &chunk->requests[i]);
+        if (error != PARSE_OK)
+        {
+            chunk->error = error;
+            chunk->errorLine = chunk->firstLine + i;
+            chunk->errorText = line;
+            return NULL;
+        }
+        line = end + 1;
+    }
+    return NULL;
+}
+
+/*
+    Prints what is wrong with a line of the trace
+    parameters:
+        error: what is wrong
+        lineNumber: line number in the file
+        line: first character of the line
+        fileEnd: end of the file
+    returns: -
+*/
+void printParseError(enum ParseError error, size_t lineNumber, const char* line, const char* fileEnd)
+{
+    const char* end = memchr(line, '\n', fileEnd - line);
+    int length = (int)((end ? end : fileEnd) - line);
+    switch (error)
+    {
+    case PARSE_RANGE:
+        fprintf(stderr, "Value exceeds uint32_t limits in line %zu: %.*s\n", lineNumber, length, line);
+        break;
+    case PARSE_CORE:
+        fprintf(stderr, "Incorrect core (expected 0 to %d) in line %zu: %.*s\n", MAX_CORES - 1, lineNumber, length,
+                line);
+        break;
+    case PARSE_WRITE:
+        fprintf(stderr, "Incorrect format for write request in line %zu: %.*s\n", lineNumber, length, line);
+        break;
+    case PARSE_READ:
+        fprintf(stderr, "Incorrect format for read request (data should be empty) in line %zu: %.*s\n", lineNumber,
+                length, line);
+        break;
+    case PARSE_TYPE:
+        fprintf(stderr, "Unknown request type in line %zu: %.*s\n", lineNumber, length, line);
+        break;
+    case PARSE_FORMAT:
+    default:
+        fprintf(stderr, "Failed to parse line %zu: %.*s\n", lineNumber, length, line);
+        break;
+    }
+}
+
+/*
+    Gets the requests from the specified csv file, an optional fourth column holds the core issuing the request.
+    The file is mapped into memory and cut at line boundaries into one chunk per processor. The chunks count their
+    lines in parallel, which sizes the request array and numbers the lines, and then parse straight into it.
     parameters:
         fileProc: the file processor
         numRequests pointer to where the number of requests will be stored
@@ -39,10 +319,11 @@ void deleteFileProcessing(FileProcessing* fileProc)
 */
 void getRequests(const FileProcessing* fileProc, size_t* numRequests, Request** requests)
 {
-    FILE* file = fopen(fileProc->csvFilePath, "r");
+    int fd = open(fileProc->csvFilePath, O_RDONLY);
+    struct stat info;
 
     //If file fails to open exit program with error
-    if (!file)
+    if (fd < 0 || fstat(fd, &info) != 0)
     {
         fprintf(stderr, "Error opening file: %s\n", fileProc->csvFilePath);
         *numRequests = 0;
@@ -51,95 +332,94 @@ void getRequests(const FileProcessing* fileProc, size_t* numRequests, Request**
         return;
     }
 
-    char line[256];
-    fgets(line, sizeof(line), file); //Skip first line since it doesn't contain data
-
-    Request* requestArray = NULL;
-    size_t requestCount = 0;
-    size_t requestCapacity = 0;
-
-    while (fgets(line, sizeof(line), file))
+    *numRequests = 0;
+    *requests = NULL;
+    size_t size = (size_t)info.st_size;
+    if (size == 0)
     {
-        char type[2];
-        unsigned int addr;
-        unsigned int data = 0;
-        int items;
-        char dataStr[256] = {0};
+        close(fd);
+        return;
+    }
+    const char* file = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED)
+    {
+        fprintf(stderr, "Error mapping file: %s\n", fileProc->csvFilePath);
+        exit(1);
+    }
+    posix_madvise((void*)file, size, POSIX_MADV_SEQUENTIAL);
 
-#ifdef DEBUG
-        printf("Reading line: %s", line);
-#endif
+    //Skip first line since it doesn't contain data
+    const char* fileEnd = file + size;
+    const char* data = memchr(file, '\n', size);
+    data = data ? data + 1 : fileEnd;
 
-        if (sscanf(line, "%1s,%x,%255s", type, &addr, dataStr) < 2)
+    //One chunk per processor, each ending after a newline
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t numChunks = (size_t)(fileEnd - data) / MIN_CHUNK_SIZE + 1;
+    if (processors > 0 && numChunks > (size_t)processors)
+    {
+        numChunks = (size_t)processors;
+    }
+    struct Chunk* chunks = calloc(numChunks, sizeof(struct Chunk));
+    if (!chunks)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        munmap((void*)file, size);
+        return;
+    }
+    const char* begin = data;
+    for (size_t i = 0; i < numChunks; i++)
+    {
+        const char* end = data + (fileEnd - data) * (i + 1) / numChunks;
+        if (end < begin)
         {
-            fprintf(stderr, "Failed to parse line: %s\n", line);
-            exit(1);
-            continue;
+            end = begin;
         }
+        const char* newline = end < fileEnd && i + 1 < numChunks ? memchr(end, '\n', fileEnd - end) : NULL;
+        chunks[i].begin = begin;
+        chunks[i].end = i + 1 == numChunks ? fileEnd : newline ? newline + 1 : fileEnd;
+        begin = chunks[i].end;
+    }
 
-        //Type = Write
-        if (type[0] == 'W')
-        {
-            if (sscanf(dataStr, "%u", &data) != 1)
-            {
-                fprintf(stderr, "Incorrect format for write request: %s\n", line);
-                exit(1);
-                continue;
-            }
-        } //Type = Read
-        else if (type[0] == 'R')
-        {
-            if (dataStr[0] != '\0')
-            {
-                // Throw error if data field is not empty
-                fprintf(stderr, "Incorrect format for read request (data should be empty): %s\n", line);
-                exit(1);
-                continue;
-            }
-            data = 0; //Ensure data variable is empty for read requests
-        }
-        else
+    runJobs(chunks, numChunks, sizeof(struct Chunk), countLines);
+    size_t requestCount = 0;
+    for (size_t i = 0; i < numChunks; i++)
+    {
+        chunks[i].firstLine = 2 + requestCount;
+        requestCount += chunks[i].numLines;
+    }
+
+    Request* requestArray = requestCount ? malloc(requestCount * sizeof(Request)) : NULL;
+    if (requestCount && !requestArray)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(chunks);
+        munmap((void*)file, size);
+        return;
+    }
+    for (size_t i = 0; i < numChunks; i++)
+    {
+        chunks[i].requests = requestArray + (chunks[i].firstLine - 2);
+    }
+    runJobs(chunks, numChunks, sizeof(struct Chunk), parseChunk);
+
+    //Report the first malformed line of the file
+    for (size_t i = 0; i < numChunks; i++)
+    {
+        if (chunks[i].error != PARSE_OK)
         {
-            fprintf(stderr, "Unknown request type: %s\n", line);
+            printParseError(chunks[i].error, chunks[i].errorLine, chunks[i].errorText, fileEnd);
             exit(1);
-            continue;
         }
+    }
 
 #ifdef DEBUG
-        printf("Parsed type: %s, addr: %x, data: %u\n", type, addr, data);
+    printf("Parsed %zu requests in %zu chunks\n", requestCount, numChunks);
 #endif
 
-        if (addr > UINT32_MAX || data > UINT32_MAX)
-        {
-            fprintf(stderr, "Value exceeds uint32_t limits: %s\n", line);
-            continue;
-        }
-
-        if (requestCount >= requestCapacity)
-        {
-            requestCapacity = (requestCapacity == 0) ? 1 : requestCapacity * 2;
-            Request* tempArray = (Request*)realloc(requestArray, requestCapacity * sizeof(Request));
-            if (tempArray == NULL)
-            {
-                fprintf(stderr, "Memory allocation failed\n");
-                free(requestArray);
-                fclose(file);
-                *numRequests = 0;
-                *requests = NULL;
-                return;
-            }
-            requestArray = tempArray;
-        }
-
-
-        Request req;
-        req.addr = addr;
-        req.data = data;
-        req.we = (type[0] == 'W') ? 1 : 0;
-        requestArray[requestCount++] = req;
-    }
-
-    fclose(file);
+    free(chunks);
+    munmap((void*)file, size);
 
     *numRequests = requestCount;
     *requests = requestArray;
@@ -4,18 +4,27 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-typedef struct
-{
-    uint32_t addr;
-    uint32_t data;
-    int we;
-} Request;
+#include "simulation.h"
+
+typedef struct Request Request;
 
 typedef struct
 {
     char* csvFilePath;
 } FileProcessing;
 
+// Ways a line of the trace can be malformed, in the order they are checked
+enum ParseError
+{
+    PARSE_OK,
+    PARSE_FORMAT,
+    PARSE_RANGE,
+    PARSE_CORE,
+    PARSE_WRITE,
+    PARSE_READ,
+    PARSE_TYPE
+};
+
 /*
     Creates a new FileProcessing object
     parameters:
@@ -42,4 +51,26 @@ void deleteFileProcessing(FileProcessing* fileProc);
 */
 void getRequests(const FileProcessing* fileProc, size_t* numRequests, Request** requests);
 
+/*
+    Parses one line of the trace: type (R or W), hexadecimal address, decimal data (empty for reads) and optionally
+    the core issuing the request
+    parameters:
+        line: first character of the line
+        end: end of the line, without the newline
+        request: receives the request
+    returns: PARSE_OK or what is wrong with the line
+*/
+enum ParseError parseRequestLine(const char* line, const char* end, Request* request);
+
+/*
+    Prints what is wrong with a line of the trace
+    parameters:
+        error: what is wrong
+        lineNumber: line number in the file
+        line: first character of the line
+        fileEnd: end of the file
+    returns: -
+*/
+void printParseError(enum ParseError error, size_t lineNumber, const char* line, const char* fileEnd);
+
 #endif // FILE_PROCESSING_H
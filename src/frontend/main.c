@@ -5,35 +5,17 @@
 #include <limits.h>
 #include <errno.h>
 #include <math.h>
+#include <string.h>
+#include <unistd.h>
 
+#include "binary_trace.h"
+#include "event_log.h"
 #include "file_processing.h"
-
-struct Request
-{
-    uint32_t addr; ///< Memory address
-    uint32_t data; ///< Requested Data
-    int we; ///< WriteEnabled (true or false)
-};
-
-struct Result
-{
-    size_t cycles; ///< Number of cycles needed to complete the simulation
-    size_t misses; ///< Number of total misses occured during the simulation
-    size_t hits; ///< Number of total hits occured during the simulation
-    size_t primitiveGateCount; ///< Number of primitive Gates needed to realize such Cache
-};
-
-extern struct Result run_simulation(
-    int cycles,
-    int directMapped,
-    unsigned cacheLines,
-    unsigned CacheLineSize,
-    unsigned cacheLatency,
-    unsigned memoryLatency,
-    size_t num_Requests,
-    struct Request* requests,
-    const char* tracefile);
-
+#include "output.h"
+#include "simulation.h"
+#include "sweep.h"
+#include "trace_cache.h"
+#include "trace_stream.h"
 
 int toSanitizedInt(const char* optarg, int* result)
 {
@@ -74,17 +56,351 @@ int toSanitizedInt(const char* optarg, int* result)
     return 0;
 }
 
+int toReplacementPolicy(const char* optarg, int* result)
+{
+    static const char* const names[] = {"lru", "fifo", "random", "plru", "srrip", "brrip", "lfu"};
+    static const int policies[] = {
+        POLICY_LRU, POLICY_FIFO, POLICY_RANDOM, POLICY_PLRU, POLICY_SRRIP, POLICY_BRRIP, POLICY_LFU
+    };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (strcmp(optarg, names[i]) == 0)
+        {
+            *result = policies[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int toInclusionPolicy(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "inclusive") == 0)
+    {
+        *result = INCLUSION_INCLUSIVE;
+    }
+    else if (strcmp(optarg, "exclusive") == 0)
+    {
+        *result = INCLUSION_EXCLUSIVE;
+    }
+    else if (strcmp(optarg, "nine") == 0)
+    {
+        *result = INCLUSION_NINE;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int toSimulationEngine(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "systemc") == 0)
+    {
+        *result = ENGINE_SYSTEMC;
+    }
+    else if (strcmp(optarg, "fast") == 0)
+    {
+        *result = ENGINE_FAST;
+    }
+    else if (strcmp(optarg, "tlm") == 0)
+    {
+        *result = ENGINE_TLM;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Maps a prefetcher name to its enum value
+int toPrefetcherKind(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "none") == 0)
+    {
+        *result = PREFETCH_NONE;
+    }
+    else if (strcmp(optarg, "next-line") == 0)
+    {
+        *result = PREFETCH_NEXT_LINE;
+    }
+    else if (strcmp(optarg, "stride") == 0)
+    {
+        *result = PREFETCH_STRIDE;
+    }
+    else if (strcmp(optarg, "stream") == 0)
+    {
+        *result = PREFETCH_STREAM;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Maps a coherence protocol name to its enum value
+int toCoherenceProtocol(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "mesi") == 0)
+    {
+        *result = COHERENCE_MESI;
+    }
+    else if (strcmp(optarg, "moesi") == 0)
+    {
+        *result = COHERENCE_MOESI;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Maps an interconnect name to its enum value
+int toInterconnect(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "bus") == 0)
+    {
+        *result = INTERCONNECT_BUS;
+    }
+    else if (strcmp(optarg, "directory") == 0)
+    {
+        *result = INTERCONNECT_DIRECTORY;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Maps a summary format name to its enum value
+int toSummaryFormat(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "text") == 0)
+    {
+        *result = SUMMARY_TEXT;
+    }
+    else if (strcmp(optarg, "json") == 0)
+    {
+        *result = SUMMARY_JSON;
+    }
+    else if (strcmp(optarg, "csv") == 0)
+    {
+        *result = SUMMARY_CSV;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Maps a request dump format name to its enum value
+int toDumpFormat(const char* optarg, int* result)
+{
+    if (strcmp(optarg, "text") == 0)
+    {
+        *result = DUMP_TEXT;
+    }
+    else if (strcmp(optarg, "binary") == 0)
+    {
+        *result = DUMP_BINARY;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Parses "<lines>:<line size>:<ways>:<latency>" of an --level option
+int toCacheLevel(const char* optarg, struct CacheLevelConfig* level)
+{
+    char trailing;
+    if (sscanf(optarg, "%u:%u:%u:%u%c", &level->cacheLines, &level->cacheLineSize, &level->ways, &level->latency,
+               &trailing) != 4)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Parses "<channels>:<banks>:<row size>" of the --dram option
+int toDramGeometry(const char* optarg, struct DramConfig* dram)
+{
+    char trailing;
+    if (sscanf(optarg, "%u:%u:%u%c", &dram->channels, &dram->banks, &dram->rowSize, &trailing) != 3
+        || dram->channels == 0 || dram->banks == 0 || dram->rowSize == 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Parses "<tRCD>:<tCAS>:<tRP>:<tBurst>" of the --dram-timing option
+int toDramTiming(const char* optarg, struct DramConfig* dram)
+{
+    char trailing;
+    if (sscanf(optarg, "%u:%u:%u:%u%c", &dram->tRCD, &dram->tCAS, &dram->tRP, &dram->tBurst, &trailing) != 4)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+// Checks that a cache level can be simulated, prints the reason and returns -1 if not
+int validateCacheLevel(const struct CacheLevelConfig* level, unsigned number, int policy)
+{
+    const unsigned sets = level->ways != 0 ? level->cacheLines / level->ways : 0;
+    if (level->cacheLines == 0 || level->cacheLineSize == 0)
+    {
+        fprintf(stderr, "L%u: cache lines and line size must be positive\n", number);
+        return -1;
+    }
+    if ((level->cacheLineSize & (level->cacheLineSize - 1)) != 0) // Blocks are found by masking the address
+    {
+        fprintf(stderr, "L%u: the line size must be a power of two, got %u\n", number, level->cacheLineSize);
+        return -1;
+    }
+    if (level->ways == 0 || level->ways > level->cacheLines || level->cacheLines % level->ways != 0
+        || (sets & (sets - 1)) != 0)
+    {
+        fprintf(stderr, "L%u: %u ways must divide %u cache lines into a power of two number of sets\n", number,
+                level->ways, level->cacheLines);
+        return -1;
+    }
+    if (policy == POLICY_PLRU && (level->ways & (level->ways - 1)) != 0)
+    {
+        fprintf(stderr, "L%u: --policy plru needs a power of two number of ways, got %u\n", number, level->ways);
+        return -1;
+    }
+    return 0;
+}
+
+// Parses the --sweep-mapping list, "direct", "full" (stored as 0 ways) or sweep lists of ways
+int toSweepMapping(const char* optarg, unsigned* values, unsigned* count)
+{
+    char* copy = strdup(optarg);
+    char* save = NULL;
+    int status = 0;
+
+    *count = 0;
+    for (char* item = strtok_r(copy, ",", &save); item && status == 0; item = strtok_r(NULL, ",", &save))
+    {
+        unsigned itemValues[MAX_SWEEP_VALUES];
+        unsigned itemCount = 0;
+        if (strcmp(item, "direct") == 0)
+        {
+            itemValues[itemCount++] = 1;
+        }
+        else if (strcmp(item, "full") == 0)
+        {
+            itemValues[itemCount++] = 0;
+        }
+        else if (parseSweepList(item, itemValues, &itemCount) != 0)
+        {
+            status = -1;
+            break;
+        }
+        if (*count + itemCount > MAX_SWEEP_VALUES)
+        {
+            status = -1;
+            break;
+        }
+        memcpy(values + *count, itemValues, itemCount * sizeof(unsigned));
+        *count += itemCount;
+    }
+    free(copy);
+    return status == 0 && *count > 0 ? 0 : -1;
+}
+
+// Parses "<first>:<last>" of the --log-* options, decimal or 0x hexadecimal, an omitted bound keeps its value
+int toRange(const char* optarg, uint64_t max, uint64_t* first, uint64_t* last)
+{
+    const char* colon = strchr(optarg, ':');
+    uint64_t low = *first;
+    uint64_t high = *last;
+    char* endptr;
+    if (!colon || strchr(optarg, '-'))
+    {
+        return -1;
+    }
+    errno = 0;
+    if (colon != optarg && ((low = strtoull(optarg, &endptr, 0)), errno != 0 || endptr != colon))
+    {
+        return -1;
+    }
+    if (colon[1] != '\0' && ((high = strtoull(colon + 1, &endptr, 0)), errno != 0 || *endptr != '\0'))
+    {
+        return -1;
+    }
+    if (low > high || high > max)
+    {
+        return -1;
+    }
+    *first = low;
+    *last = high;
+    return 0;
+}
+
+// Value of the long options without a letter of their own, past every character getopt_long can return
+#define OPTION_STATS_INTERVAL 256
+
 int main(int argc, char* argv[])
 {
     // Default values for simulation parameters
     int cycles = 1000;
+    int engine = ENGINE_SYSTEMC;
+    unsigned quantum = 1000;
+    int mmapMemory = 0;
+    struct DramConfig dram = {0, 0, 0, 14, 14, 14, 4, PAGE_OPEN}; // No DRAM model unless --dram is given
+    unsigned mshrs = 0; // 0 = blocking cache
+    unsigned issueWindow = 0; // 0 = default window of a non-blocking cache
+    int prefetcher = PREFETCH_NONE;
+    unsigned prefetchDegree = 2;
+    unsigned prefetchEntries = 16;
+    unsigned victimEntries = 0; // 0 = no victim cache
+    unsigned victimLatency = 1;
+    int coherence = COHERENCE_MESI; // Only used by multi-core traces
+    int interconnect = INTERCONNECT_BUS;
+    unsigned coherenceLatency = 10;
+    int missRatioCurve = 0;
+    unsigned sweepLines[MAX_SWEEP_VALUES], numSweepLines = 0; // Sweep lists, empty ones take the single value
+    unsigned sweepLineSizes[MAX_SWEEP_VALUES], numSweepLineSizes = 0;
+    unsigned sweepWays[MAX_SWEEP_VALUES], numSweepWays = 0;
+    unsigned sweepCacheLatencies[MAX_SWEEP_VALUES], numSweepCacheLatencies = 0;
+    unsigned sweepMemoryLatencies[MAX_SWEEP_VALUES], numSweepMemoryLatencies = 0;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
     int directMapped = 0; //if directMapped & fullassociative are 0 the simulation will run fullassociative as default
     int fullassociative = 0;
+    unsigned ways = 0; // 0 = all lines in one set (fully associative)
+    int policy = POLICY_LRU;
+    int inclusion = INCLUSION_INCLUSIVE;
+    int writePolicy = WRITE_THROUGH;
+    int writeAllocate = 1;
+    struct CacheLevelConfig lowerLevels[MAX_CACHE_LEVELS - 1]; // L2 and below, L1 comes from the options above
+    unsigned numLowerLevels = 0;
     unsigned cacheLineSize = 8;
     unsigned cacheLines = 16;
     unsigned cacheLatency = 2;
     unsigned memoryLatency = 10;
     const char* tracefile = NULL;
+    const char* convertPath = NULL;
+    const char* eventLogPath = NULL;
+    const char* exportVcdPath = NULL;
+    struct EventFilter eventFilter = {0, UINT64_MAX, 0, UINT64_MAX, 0, UINT32_MAX, 0}; // Everything
+    int eventFilterSet = 0;
+    int traceCache = 1;
+    int stream = 0;
+    int summaryFormat = SUMMARY_TEXT;
+    const char* dumpPath = NULL; // The requests are only written with --dump-requests
+    int dumpFormat = DUMP_TEXT;
+    unsigned statsInterval = 10000; // Requests per interval of the hit rate series
     const char* input_file_path = "/csv/matrix_multiplication_trace.csv";
 
     static struct option long_options[] = {
@@ -95,7 +411,51 @@ int main(int argc, char* argv[])
         {"cachelines", required_argument, 0, 'e'},
         {"cache-latency", required_argument, 0, 'f'},
         {"memory-latency", required_argument, 0, 'g'},
+        {"ways", required_argument, 0, 'j'},
+        {"policy", required_argument, 0, 'k'},
+        {"level", required_argument, 0, 'l'},
+        {"inclusion", required_argument, 0, 'm'},
+        {"engine", required_argument, 0, 'r'},
+        {"quantum", required_argument, 0, 'z'},
+        {"mmap-memory", no_argument, 0, 'A'},
+        {"dram", required_argument, 0, 'B'},
+        {"dram-timing", required_argument, 0, 'C'},
+        {"page-policy", required_argument, 0, 'D'},
+        {"mshrs", required_argument, 0, 'E'},
+        {"window", required_argument, 0, 'F'},
+        {"prefetch", required_argument, 0, 'G'},
+        {"prefetch-degree", required_argument, 0, 'H'},
+        {"prefetch-entries", required_argument, 0, 'I'},
+        {"victim-entries", required_argument, 0, 'M'},
+        {"victim-latency", required_argument, 0, 'N'},
+        {"coherence", required_argument, 0, 'J'},
+        {"interconnect", required_argument, 0, 'K'},
+        {"coherence-latency", required_argument, 0, 'L'},
+        {"mrc", no_argument, 0, 's'},
+        {"sweep-cachelines", required_argument, 0, 't'},
+        {"sweep-cacheline-size", required_argument, 0, 'u'},
+        {"sweep-mapping", required_argument, 0, 'v'},
+        {"sweep-cache-latency", required_argument, 0, 'w'},
+        {"sweep-memory-latency", required_argument, 0, 'x'},
+        {"jobs", required_argument, 0, 'y'},
+        {"write-through", no_argument, 0, 'n'},
+        {"write-back", no_argument, 0, 'o'},
+        {"write-allocate", no_argument, 0, 'p'},
+        {"no-write-allocate", no_argument, 0, 'q'},
         {"tf=", required_argument, 0, 'i'},
+        {"convert", required_argument, 0, 'O'},
+        {"no-trace-cache", no_argument, 0, 'P'},
+        {"stream", no_argument, 0, 'Q'},
+        {"event-log", required_argument, 0, 'R'},
+        {"log-requests", required_argument, 0, 'S'},
+        {"log-cycles", required_argument, 0, 'T'},
+        {"log-addresses", required_argument, 0, 'U'},
+        {"log-misses", no_argument, 0, 'V'},
+        {"export-vcd", required_argument, 0, 'W'},
+        {"summary", required_argument, 0, 'X'},
+        {"dump-requests", required_argument, 0, 'Y'},
+        {"dump-format", required_argument, 0, 'Z'},
+        {"stats-interval", required_argument, 0, OPTION_STATS_INTERVAL},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
@@ -211,118 +571,1034 @@ int main(int argc, char* argv[])
                 fprintf(stderr, "  --fullassociative          Set cache mapping to fully associative\n");
                 fprintf(stderr, "  --cacheline-size <size>    Set the cache line size\n");
                 fprintf(stderr, "  --cachelines <number>      Set the number of cache lines\n");
+                fprintf(stderr, "  --ways <number>            Set the associativity (1 = direct mapped)\n");
+                fprintf(stderr, "  --policy <name>            Set the replacement policy\n");
+                fprintf(stderr, "                             (lru, fifo, random, plru, srrip, brrip, lfu)\n");
                 fprintf(stderr, "  --cache-latency <latency>  Set the cache latency\n");
+                fprintf(stderr, "  --level <l>:<s>:<w>:<lat>  Add a lower cache level (lines, line size, ways,\n");
+                fprintf(stderr, "                             latency), repeat for L3 and L4\n");
+                fprintf(stderr, "  --inclusion <policy>       Set the inclusion policy (inclusive, exclusive, nine)\n");
+                fprintf(stderr, "  --engine <engine>          Set the simulation engine (systemc, fast, tlm)\n");
+                fprintf(stderr, "  --quantum <cycles>         Set the time quantum of the tlm engine (default 1000)\n");
+                fprintf(stderr, "  --mrc                      Print the miss-ratio curve of a fully associative LRU\n");
+                fprintf(stderr, "                             cache for 1 to --cachelines lines instead\n");
+                fprintf(stderr, "  --sweep-cachelines <list>  Simulate every listed number of cache lines, lists\n");
+                fprintf(stderr, "                             are comma separated numbers or ranges\n");
+                fprintf(stderr, "                             (1-4, 2-8+2, 16-1024*2)\n");
+                fprintf(stderr, "  --sweep-cacheline-size <list>  Simulate every listed cache line size\n");
+                fprintf(stderr, "  --sweep-mapping <list>     Simulate every listed mapping (direct, full, ways)\n");
+                fprintf(stderr, "  --sweep-cache-latency <list>   Simulate every listed cache latency\n");
+                fprintf(stderr, "  --sweep-memory-latency <list>  Simulate every listed memory latency\n");
+                fprintf(stderr, "  --jobs <number>            Number of parallel sweep workers (default: all cores)\n");
+                fprintf(stderr, "  --write-through            Write every write on to memory (default)\n");
+                fprintf(stderr, "  --write-back               Keep writes in the cache until dirty blocks leave it\n");
+                fprintf(stderr, "  --write-allocate           Allocate a block on a write miss (default)\n");
+                fprintf(stderr, "  --no-write-allocate        Write misses go around the cache\n");
                 fprintf(stderr, "  --memory-latency <latency> Set the memory latency\n");
-                fprintf(stderr, "  --tf=<filename>            Set the trace file name\n");
-                fprintf(stderr, "  <filename>                 Positional Argument: Set the input file path\n");
+                fprintf(stderr, "  --mmap-memory              Back the memory by one anonymous mapping of the whole\n");
+                fprintf(stderr, "                             address space instead of a page table\n");
+                fprintf(stderr, "  --dram <c>:<b>:<row>       Replace the memory latency by a DRAM model (channels,\n");
+                fprintf(stderr, "                             banks per channel, addresses per row)\n");
+                fprintf(stderr, "  --dram-timing <rcd>:<cas>:<rp>:<burst>  Set the DRAM timings in cycles\n");
+                fprintf(stderr, "                             (default 14:14:14:4)\n");
+                fprintf(stderr, "  --page-policy <policy>     Set the DRAM row buffer policy (open, closed)\n");
+                fprintf(stderr, "  --mshrs <number>           Make L1 non-blocking with this many outstanding\n");
+                fprintf(stderr, "                             misses\n");
+                fprintf(stderr, "  --window <number>          Set the requests in flight of a non-blocking cache\n");
+                fprintf(stderr, "                             (default 16)\n");
+                fprintf(stderr, "  --prefetch <kind>          Set the L1 prefetcher\n");
+                fprintf(stderr, "                             (none, next-line, stride, stream)\n");
+                fprintf(stderr, "  --prefetch-degree <number> Set the blocks fetched ahead (default 2)\n");
+                fprintf(stderr, "  --prefetch-entries <number>  Set the stride table entries or stream buffers\n");
+                fprintf(stderr, "                             (default 16)\n");
+                fprintf(stderr, "  --victim-entries <number>  Add a fully associative victim cache behind L1\n");
+                fprintf(stderr, "  --victim-latency <latency> Set the latency of the victim cache (default 1)\n");
+                fprintf(stderr, "  --coherence <protocol>     Set the protocol between the private L1 caches of a\n");
+                fprintf(stderr, "                             multi-core trace (mesi, moesi), they are write-back\n");
+                fprintf(stderr, "  --interconnect <kind>      Connect the private caches by a bus or a directory\n");
+                fprintf(stderr, "  --coherence-latency <latency>  Set the cycles of a bus transaction or directory\n");
+                fprintf(stderr, "                             round trip (default 10)\n");
+                fprintf(stderr, "  --tf=<filename>            Export the logged requests as a VCD\n");
+                fprintf(stderr, "  --event-log <filename>     Log every request (address, hit, latency, evicted\n");
+                fprintf(stderr, "                             block) into a binary event log\n");
+                fprintf(stderr, "  --log-requests <a>:<b>     Only log the requests a to b (0 is the first)\n");
+                fprintf(stderr, "  --log-cycles <a>:<b>       Only log the requests starting in cycles a to b\n");
+                fprintf(stderr, "  --log-addresses <lo>:<hi>  Only log the addresses lo to hi (0x for hex)\n");
+                fprintf(stderr, "  --log-misses               Only log the requests L1 did not serve\n");
+                fprintf(stderr, "  --export-vcd <filename>    Export the event log given as input as a VCD and\n");
+                fprintf(stderr, "                             exit\n");
+                fprintf(stderr, "  --summary <format>         Print the results as text (default), json or csv\n");
+                fprintf(stderr, "  --dump-requests <filename> Write every request with the data read to a file\n");
+                fprintf(stderr, "  --dump-format <format>     Set the format of the request dump (text, binary)\n");
+                fprintf(stderr, "  --stats-interval <number>  Set the requests per interval of the hit rate series\n");
+                fprintf(stderr, "                             of the json summary, 0 for none (default 10000)\n");
+                fprintf(stderr, "  --convert <filename>       Write the input as a binary trace and exit, binary\n");
+                fprintf(stderr, "                             traces are recognized as input by their header\n");
+                fprintf(stderr, "  --no-trace-cache           Neither use nor write the parsed csv trace cached in\n");
+                fprintf(stderr, "                             <filename>%s\n", TRACE_CACHE_SUFFIX);
+                fprintf(stderr, "  --stream                   Simulate the csv trace while a reader thread parses\n");
+                fprintf(stderr, "                             it, in constant memory (--engine fast, single core)\n");
+                fprintf(stderr, "  <filename>                 Positional Argument: Set the input file path, -\n");
+                fprintf(stderr, "                             streams standard input\n");
                 fprintf(stderr, "  -h, --help                 Display this help and exit\n");
                 return 0;
             }
-        case 'i': //--tf=<filename>
+        case 'j': //--ways <number>
             {
-                tracefile = optarg;
+                if (toSanitizedInt(optarg, &number_input) == 0 && number_input > 0)
+                {
 #ifdef DEBUG
-                printf("Tracefile: %s\n", tracefile);
+                    printf("ways: %d\n", number_input);
 #endif
+                    ways = number_input;
+                }
+                else
+                {
+                    fprintf(stderr, "Invalid number of ways: %s\n", optarg);
+                    return 1;
+                }
                 break;
             }
-        default:
-            fprintf(stderr, "Unknown option: %s\n", argv[optind - 1]);
-            fprintf(stderr, "Use -h or --help for displaying valid options.\n");
-            return 1;
-        }
-    }
-
-    if (fullassociative && directMapped)
-    {
-        perror("Please choose only one of --fullassociative or --directmapped");
-        return 1;
-    }
-
-    struct Request* requests = NULL;
-    size_t num_Requests = 0;
-
-    //Positional parameter handling
-    if (optind < argc)
-    {
-        input_file_path = argv[optind];
-
+        case 'k': //--policy <name>
+            {
+                if (toReplacementPolicy(optarg, &policy) != 0)
+                {
+                    fprintf(stderr, "Unknown replacement policy: %s\n", optarg);
+                    return 1;
+                }
 #ifdef DEBUG
-        printf("Input file: %s\n", input_file_path);
+                printf("policy: %s\n", optarg);
 #endif
-
-        FileProcessing* fileProc = createFileProcessing(input_file_path);
-        if (!fileProc)
-        {
-            fprintf(stderr, "Failed to initialize FileProcessing.\n");
-            return 1;
-        }
-
-        getRequests(fileProc, &num_Requests, &requests);
-
-        if (num_Requests > 0 && requests != NULL)
-        {
+                break;
+            }
+        case 'l': //--level <lines>:<line size>:<ways>:<latency>
+            {
+                if (numLowerLevels == MAX_CACHE_LEVELS - 1)
+                {
+                    fprintf(stderr, "At most %d cache levels are supported\n", MAX_CACHE_LEVELS);
+                    return 1;
+                }
+                if (toCacheLevel(optarg, &lowerLevels[numLowerLevels]) != 0)
+                {
+                    fprintf(stderr, "Invalid cache level (expected <lines>:<line size>:<ways>:<latency>): %s\n",
+                            optarg);
+                    return 1;
+                }
 #ifdef DEBUG
-            printf("Fetched %zu requests:\n", num_Requests);
-            for (size_t i = 0; i < num_Requests; i++)
+                printf("level: %s\n", optarg);
+#endif
+                numLowerLevels++;
+                break;
+            }
+        case 'm': //--inclusion <policy>
             {
-                printf("Request %zu: Addr = %u, Data = %u, WE = %d\n",
-                       i, requests[i].addr, requests[i].data, requests[i].we);
+                if (toInclusionPolicy(optarg, &inclusion) != 0)
+                {
+                    fprintf(stderr, "Unknown inclusion policy: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("inclusion: %s\n", optarg);
+#endif
+                break;
             }
+        case 'r': //--engine <engine>
+            {
+                if (toSimulationEngine(optarg, &engine) != 0)
+                {
+                    fprintf(stderr, "Unknown engine: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("engine: %s\n", optarg);
 #endif
-        }
-        else
-        {
-            printf("No requests fetched or an error occurred.\n");
-            return 1;
-        }
-        // Clean up
-        deleteFileProcessing(fileProc);
-    }
-
-    const unsigned offsetbits = log2(cacheLineSize);
-    const unsigned indexbits = log2(cacheLines);
-    for (size_t i = 0; i < num_Requests; i++) // Check if all request adresses are within the bounds of the cache size
-    {
-        const unsigned offset = requests[i].addr & ((1 << offsetbits) - 1);
-        const unsigned index = (requests[i].addr >> offsetbits) & ((1 << indexbits) - 1);
+                break;
+            }
+        case 'z': //--quantum <cycles>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input < 0)
+                {
+                    fprintf(stderr, "Invalid quantum: %s\n", optarg);
+                    return 1;
+                }
+                quantum = number_input;
+#ifdef DEBUG
+                printf("quantum: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'A': //--mmap-memory
+            {
+                mmapMemory = 1;
+#ifdef DEBUG
+                printf("mmap-memory\n");
+#endif
+                break;
+            }
+        case 'B': //--dram <channels>:<banks>:<row size>
+            {
+                if (toDramGeometry(optarg, &dram) != 0)
+                {
+                    fprintf(stderr, "Invalid DRAM (expected <channels>:<banks>:<row size>): %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("dram: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'C': //--dram-timing <tRCD>:<tCAS>:<tRP>:<tBurst>
+            {
+                if (toDramTiming(optarg, &dram) != 0)
+                {
+                    fprintf(stderr, "Invalid DRAM timing (expected <tRCD>:<tCAS>:<tRP>:<tBurst>): %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("dram-timing: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'D': //--page-policy <policy>
+            {
+                if (strcmp(optarg, "open") == 0)
+                {
+                    dram.pagePolicy = PAGE_OPEN;
+                }
+                else if (strcmp(optarg, "closed") == 0)
+                {
+                    dram.pagePolicy = PAGE_CLOSED;
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown page policy: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("page-policy: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'E': //--mshrs <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input < 0)
+                {
+                    fprintf(stderr, "Invalid number of MSHRs: %s\n", optarg);
+                    return 1;
+                }
+                mshrs = number_input;
+#ifdef DEBUG
+                printf("mshrs: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'F': //--window <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input <= 0)
+                {
+                    fprintf(stderr, "Invalid window: %s\n", optarg);
+                    return 1;
+                }
+                issueWindow = number_input;
+#ifdef DEBUG
+                printf("window: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'G': //--prefetch <kind>
+            {
+                if (toPrefetcherKind(optarg, &prefetcher) != 0)
+                {
+                    fprintf(stderr, "Unknown prefetcher: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("prefetch: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'H': //--prefetch-degree <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input <= 0)
+                {
+                    fprintf(stderr, "Invalid prefetch degree: %s\n", optarg);
+                    return 1;
+                }
+                prefetchDegree = number_input;
+#ifdef DEBUG
+                printf("prefetch-degree: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'I': //--prefetch-entries <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input <= 0)
+                {
+                    fprintf(stderr, "Invalid number of prefetch entries: %s\n", optarg);
+                    return 1;
+                }
+                prefetchEntries = number_input;
+#ifdef DEBUG
+                printf("prefetch-entries: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'M': //--victim-entries <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input <= 0)
+                {
+                    fprintf(stderr, "Invalid number of victim cache entries: %s\n", optarg);
+                    return 1;
+                }
+                victimEntries = number_input;
+#ifdef DEBUG
+                printf("victim-entries: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'N': //--victim-latency <latency>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input < 0)
+                {
+                    fprintf(stderr, "Invalid victim cache latency: %s\n", optarg);
+                    return 1;
+                }
+                victimLatency = number_input;
+#ifdef DEBUG
+                printf("victim-latency: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'J': //--coherence <protocol>
+            {
+                if (toCoherenceProtocol(optarg, &coherence) != 0)
+                {
+                    fprintf(stderr, "Unknown coherence protocol: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("coherence: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'K': //--interconnect <kind>
+            {
+                if (toInterconnect(optarg, &interconnect) != 0)
+                {
+                    fprintf(stderr, "Unknown interconnect: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("interconnect: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'L': //--coherence-latency <latency>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input < 0)
+                {
+                    fprintf(stderr, "Invalid coherence latency: %s\n", optarg);
+                    return 1;
+                }
+                coherenceLatency = number_input;
+#ifdef DEBUG
+                printf("coherence-latency: %d\n", number_input);
+#endif
+                break;
+            }
+        case 's': //--mrc
+            {
+                missRatioCurve = 1;
+#ifdef DEBUG
+                printf("mrc\n");
+#endif
+                break;
+            }
+        case 't': //--sweep-cachelines <list>
+        case 'u': //--sweep-cacheline-size <list>
+        case 'w': //--sweep-cache-latency <list>
+        case 'x': //--sweep-memory-latency <list>
+            {
+                unsigned* values = opt == 't' ? sweepLines : opt == 'u' ? sweepLineSizes
+                                 : opt == 'w' ? sweepCacheLatencies : sweepMemoryLatencies;
+                unsigned* count = opt == 't' ? &numSweepLines : opt == 'u' ? &numSweepLineSizes
+                                : opt == 'w' ? &numSweepCacheLatencies : &numSweepMemoryLatencies;
+                if (parseSweepList(optarg, values, count) != 0)
+                {
+                    fprintf(stderr, "Invalid sweep list (at most %d values): %s\n", MAX_SWEEP_VALUES, optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("%s: %s\n", long_options[option_index].name, optarg);
+#endif
+                break;
+            }
+        case 'v': //--sweep-mapping <list>
+            {
+                if (toSweepMapping(optarg, sweepWays, &numSweepWays) != 0)
+                {
+                    fprintf(stderr, "Invalid sweep mapping list (direct, full or ways): %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("sweep-mapping: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'y': //--jobs <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) != 0 || number_input <= 0)
+                {
+                    fprintf(stderr, "Invalid number of jobs: %s\n", optarg);
+                    return 1;
+                }
+                jobs = number_input;
+#ifdef DEBUG
+                printf("jobs: %d\n", number_input);
+#endif
+                break;
+            }
+        case 'n': //--write-through
+            {
+                writePolicy = WRITE_THROUGH;
+#ifdef DEBUG
+                printf("write-through\n");
+#endif
+                break;
+            }
+        case 'o': //--write-back
+            {
+                writePolicy = WRITE_BACK;
+#ifdef DEBUG
+                printf("write-back\n");
+#endif
+                break;
+            }
+        case 'p': //--write-allocate
+            {
+                writeAllocate = 1;
+#ifdef DEBUG
+                printf("write-allocate\n");
+#endif
+                break;
+            }
+        case 'q': //--no-write-allocate
+            {
+                writeAllocate = 0;
+#ifdef DEBUG
+                printf("no-write-allocate\n");
+#endif
+                break;
+            }
+        case 'i': //--tf=<filename>
+            {
+                tracefile = optarg;
+#ifdef DEBUG
+                printf("Tracefile: %s\n", tracefile);
+#endif
+                break;
+            }
+        case 'O': //--convert <filename>
+            {
+                convertPath = optarg;
+#ifdef DEBUG
+                printf("convert: %s\n", convertPath);
+#endif
+                break;
+            }
+        case 'P': //--no-trace-cache
+            {
+                traceCache = 0;
+#ifdef DEBUG
+                printf("no-trace-cache\n");
+#endif
+                break;
+            }
+        case 'Q': //--stream
+            {
+                stream = 1;
+#ifdef DEBUG
+                printf("stream\n");
+#endif
+                break;
+            }
+        case 'R': //--event-log <filename>
+            {
+                eventLogPath = optarg;
+#ifdef DEBUG
+                printf("event-log: %s\n", eventLogPath);
+#endif
+                break;
+            }
+        case 'S': //--log-requests <first>:<last>
+            {
+                if (toRange(optarg, UINT64_MAX, &eventFilter.firstRequest, &eventFilter.lastRequest) != 0)
+                {
+                    fprintf(stderr, "Invalid request range (expected <first>:<last>): %s\n", optarg);
+                    return 1;
+                }
+                eventFilterSet = 1;
+#ifdef DEBUG
+                printf("log-requests: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'T': //--log-cycles <first>:<last>
+            {
+                if (toRange(optarg, UINT64_MAX, &eventFilter.firstCycle, &eventFilter.lastCycle) != 0)
+                {
+                    fprintf(stderr, "Invalid cycle window (expected <first>:<last>): %s\n", optarg);
+                    return 1;
+                }
+                eventFilterSet = 1;
+#ifdef DEBUG
+                printf("log-cycles: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'U': //--log-addresses <low>:<high>
+            {
+                uint64_t low = eventFilter.lowAddress;
+                uint64_t high = eventFilter.highAddress;
+                if (toRange(optarg, UINT32_MAX, &low, &high) != 0)
+                {
+                    fprintf(stderr, "Invalid address range (expected <low>:<high>): %s\n", optarg);
+                    return 1;
+                }
+                eventFilter.lowAddress = (uint32_t)low;
+                eventFilter.highAddress = (uint32_t)high;
+                eventFilterSet = 1;
+#ifdef DEBUG
+                printf("log-addresses: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'V': //--log-misses
+            {
+                eventFilter.missesOnly = 1;
+                eventFilterSet = 1;
+#ifdef DEBUG
+                printf("log-misses\n");
+#endif
+                break;
+            }
+        case 'W': //--export-vcd <filename>
+            {
+                exportVcdPath = optarg;
+#ifdef DEBUG
+                printf("export-vcd: %s\n", exportVcdPath);
+#endif
+                break;
+            }
+        case 'X': //--summary <format>
+            {
+                if (toSummaryFormat(optarg, &summaryFormat) != 0)
+                {
+                    fprintf(stderr, "Invalid summary format: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("summary: %s\n", optarg);
+#endif
+                break;
+            }
+        case 'Y': //--dump-requests <filename>
+            {
+                dumpPath = optarg;
+#ifdef DEBUG
+                printf("dump-requests: %s\n", dumpPath);
+#endif
+                break;
+            }
+        case 'Z': //--dump-format <format>
+            {
+                if (toDumpFormat(optarg, &dumpFormat) != 0)
+                {
+                    fprintf(stderr, "Invalid dump format: %s\n", optarg);
+                    return 1;
+                }
+#ifdef DEBUG
+                printf("dump-format: %s\n", optarg);
+#endif
+                break;
+            }
+        case OPTION_STATS_INTERVAL: //--stats-interval <number>
+            {
+                if (toSanitizedInt(optarg, &number_input) == 0 && number_input >= 0)
+                {
+#ifdef DEBUG
+                    printf("stats-interval: %d\n", number_input);
+#endif
+                    statsInterval = number_input;
+                }
+                else
+                {
+                    fprintf(stderr, "Invalid stats interval: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+        default:
+            fprintf(stderr, "Unknown option: %s\n", argv[optind - 1]);
+            fprintf(stderr, "Use -h or --help for displaying valid options.\n");
+            return 1;
+        }
+    }
+
+    if (fullassociative && directMapped)
+    {
+        perror("Please choose only one of --fullassociative or --directmapped");
+        return 1;
+    }
+
+    if (ways != 0 && (directMapped || fullassociative))
+    {
+        fprintf(stderr, "Please choose only one of --ways, --fullassociative or --directmapped\n");
+        return 1;
+    }
+
+    // An event log given as input is only exported
+    if (exportVcdPath)
+    {
+        if (optind >= argc || !isEventLog(argv[optind]))
+        {
+            fprintf(stderr, "--export-vcd needs an event log as input\n");
+            return 1;
+        }
+        FILE* log = fopen(argv[optind], "rb");
+        size_t exported = 0;
+        const int failed = !log || exportEventLogVcd(log, exportVcdPath, &exported) != 0;
+        if (log)
+        {
+            fclose(log);
+        }
+        if (failed)
+        {
+            return 1;
+        }
+        printf("Exported %zu events to %s\n", exported, exportVcdPath);
+        return 0;
+    }
+
+    if (engine == ENGINE_TLM && (tracefile || eventLogPath))
+    {
+        fprintf(stderr, "--tf and --event-log need --engine fast or systemc, the TLM engine logs no requests\n");
+        return 1;
+    }
+
+    if (eventFilterSet && !tracefile && !eventLogPath)
+    {
+        fprintf(stderr, "--log-requests, --log-cycles, --log-addresses and --log-misses filter --event-log or --tf\n");
+        return 1;
+    }
+
+    if (issueWindow != 0 && mshrs == 0)
+    {
+        fprintf(stderr, "--window needs --mshrs, a blocking cache has one request in flight\n");
+        return 1;
+    }
+
+    if (missRatioCurve && (directMapped || ways != 0 || numLowerLevels != 0 || policy != POLICY_LRU ||
+                           writePolicy != WRITE_THROUGH || !writeAllocate || tracefile || eventLogPath ||
+                           dram.channels != 0 || mshrs != 0 || prefetcher != PREFETCH_NONE || victimEntries != 0))
+    {
+        fprintf(stderr, "--mrc models a single blocking, fully associative, write-through, write-allocate LRU cache "
+                "without prefetcher or victim cache and with a flat memory latency, and logs no requests\n");
+        return 1;
+    }
+
+    const int sweep = numSweepLines || numSweepLineSizes || numSweepWays || numSweepCacheLatencies
+                      || numSweepMemoryLatencies;
+    if (sweep && (missRatioCurve || tracefile || eventLogPath))
+    {
+        fprintf(stderr, "A sweep can be combined with neither --mrc, --tf nor --event-log\n");
+        return 1;
+    }
+
+    // A trace read from standard input can only be streamed
+    if (optind < argc && strcmp(argv[optind], "-") == 0)
+    {
+        stream = 1;
+    }
+    if (stream && (optind >= argc || engine != ENGINE_FAST || missRatioCurve || sweep || convertPath))
+    {
+        fprintf(stderr, "--stream needs a csv trace (- for standard input) and --engine fast, and can be combined "
+                "with neither --mrc, a sweep nor --convert\n");
+        return 1;
+    }
+    if (stream && strcmp(argv[optind], "-") != 0 && isBinaryTrace(argv[optind]))
+    {
+        fprintf(stderr, "--stream reads csv traces, %s is a binary trace\n", argv[optind]);
+        return 1;
+    }
+
+    if (dumpPath && (stream || missRatioCurve || sweep || convertPath))
+    {
+        fprintf(stderr, "--dump-requests writes the requests of a single simulation, it can be combined with neither "
+                "--stream, --mrc, a sweep nor --convert\n");
+        return 1;
+    }
+
+    // L1 from the single level options, then the --level options in order
+    struct SimulationConfig config;
+    memset(&config, 0, sizeof(config));
+    config.cycles = cycles;
+    config.discardReadData = !dumpPath; // Only a dump shows the data read, the mapped trace cache stays untouched
+    config.statsInterval = statsInterval;
+    config.engine = engine;
+    config.quantum = quantum;
+    config.mmapMemory = mmapMemory;
+    config.memoryLatency = memoryLatency;
+    config.dram = dram;
+    config.mshrs = mshrs;
+    config.issueWindow = issueWindow != 0 ? issueWindow : 16;
+    config.prefetcher = prefetcher;
+    config.prefetchDegree = prefetchDegree;
+    config.prefetchEntries = prefetchEntries;
+    config.victimEntries = victimEntries;
+    config.victimLatency = victimLatency;
+    config.cores = 1;
+    config.coherence = coherence;
+    config.interconnect = interconnect;
+    config.coherenceLatency = coherenceLatency;
+    config.policy = policy;
+    config.inclusion = inclusion;
+    config.writePolicy = writePolicy;
+    config.writeAllocate = writeAllocate;
+    config.numLevels = 1 + numLowerLevels;
+    config.levels[0].cacheLines = cacheLines;
+    config.levels[0].cacheLineSize = cacheLineSize;
+    config.levels[0].ways = directMapped ? 1 : (ways != 0 ? ways : cacheLines);
+    config.levels[0].latency = cacheLatency;
+    for (unsigned i = 0; i < numLowerLevels; i++)
+    {
+        config.levels[i + 1] = lowerLevels[i];
+    }
+
+    for (unsigned i = 0; i < config.numLevels; i++)
+    {
+        if (validateCacheLevel(&config.levels[i], i + 1, policy) != 0)
+        {
+            return 1;
+        }
+        if (inclusion == INCLUSION_EXCLUSIVE && config.levels[i].cacheLineSize != cacheLineSize)
+        {
+            fprintf(stderr, "--inclusion exclusive needs the same line size in every level\n");
+            return 1;
+        }
+    }
+
+    struct Request* requests = NULL;
+    size_t num_Requests = 0;
+
+    //Positional parameter handling, a streamed trace is read while it is simulated
+    if (optind < argc && !stream)
+    {
+        input_file_path = argv[optind];
+
+#ifdef DEBUG
+        printf("Input file: %s\n", input_file_path);
+#endif
+
+        FileProcessing* fileProc = createFileProcessing(input_file_path);
+        if (!fileProc)
+        {
+            fprintf(stderr, "Failed to initialize FileProcessing.\n");
+            return 1;
+        }
+
+        // A sidecar written by an earlier run saves parsing a csv trace again, binary traces decode fast enough and
+        // are several times smaller than their sidecar would be
+        if (isBinaryTrace(input_file_path))
+        {
+            readBinaryTrace(input_file_path, &num_Requests, &requests);
+        }
+        else if (traceCache && loadTraceCache(input_file_path, &num_Requests, &requests) == 0)
+        {
+#ifdef DEBUG
+            printf("Mapped the cached requests of %s\n", input_file_path);
+#endif
+        }
+        else
+        {
+            getRequests(fileProc, &num_Requests, &requests);
+            if (traceCache)
+            {
+                writeTraceCache(input_file_path, requests, num_Requests);
+            }
+        }
+
+        if (num_Requests > 0 && requests != NULL)
+        {
+#ifdef DEBUG
+            printf("Fetched %zu requests\n", num_Requests);
+#endif
+#if DEBUG_LEVEL >= 2
+            for (size_t i = 0; i < num_Requests; i++)
+            {
+                printf("Request %zu: Addr = %u, Data = %u, WE = %d\n",
+                       i, requests[i].addr, requests[i].data, requests[i].we);
+            }
+#endif
+        }
+        else
+        {
+            printf("No requests fetched or an error occurred.\n");
+            return 1;
+        }
+        // Clean up
+        deleteFileProcessing(fileProc);
+    }
+
+    if (convertPath)
+    {
+        const size_t size = writeBinaryTrace(convertPath, requests, num_Requests);
+        freeRequests(requests);
+        if (size == 0)
+        {
+            return 1;
+        }
+        printf("Wrote %zu requests to %s (%zu bytes)\n", num_Requests, convertPath, size);
+        return 0;
+    }
+
+    const unsigned offsetbits = log2(cacheLineSize);
+    const unsigned indexbits = log2(cacheLines);
+    for (size_t i = 0; i < num_Requests; i++) // Check if all request adresses are within the bounds of the cache size
+    {
+        const unsigned offset = requests[i].addr & ((1 << offsetbits) - 1);
+        const unsigned index = (requests[i].addr >> offsetbits) & ((1 << indexbits) - 1);
         if (offset >= cacheLineSize)
         {
             fprintf(stderr, "Request %zu: Offset %u is out of bounds for cache line size %u\n", i, offset,
                     cacheLineSize);
-            free(requests);
+            freeRequests(requests);
             return 1;
         }
         if (index >= cacheLines)
         {
             fprintf(stderr, "Request %zu: Index %u is out of bounds for cache lines %u\n", i, index, cacheLines);
-            free(requests);
+            freeRequests(requests);
             return 1;
         }
     }
 
-    // Simulation
-    struct Result result = run_simulation(
-        cycles, directMapped, cacheLines, cacheLineSize,
-        cacheLatency, memoryLatency, num_Requests,
-        requests, tracefile
-    );
-
-    // Results
-    printf("Simulation Results:\n");
-    printf("Cycles: %zu\n", result.cycles);
-    printf("Misses: %zu\n", result.misses);
-    printf("Hits: %zu\n", result.hits);
-    printf("Primitive Gate Count: %zu\n", result.primitiveGateCount);
-    printf("Number of Requests: %zu\n", num_Requests);
-
-    // print requests
+    // A trace with a core column runs one private L1 per core
     for (size_t i = 0; i < num_Requests; i++)
     {
-        printf("Request %zu: Addr = %u, Data = %u, WE = %d\n",
-               i, requests[i].addr, requests[i].data, requests[i].we);
+        if (requests[i].core >= config.cores)
+        {
+            config.cores = requests[i].core + 1;
+        }
+    }
+    if (config.cores > 1 && (engine != ENGINE_FAST || numLowerLevels != 0 || mshrs != 0 ||
+                             prefetcher != PREFETCH_NONE || victimEntries != 0 || dram.channels != 0 ||
+                             missRatioCurve || tracefile || eventLogPath))
+    {
+        fprintf(stderr, "A multi-core trace needs --engine fast and models one coherent L1 per core over a flat "
+                "memory latency,\nwithout --level, --mshrs, --prefetch, --victim-entries, --dram, --mrc, --tf or "
+                "--event-log\n");
+        freeRequests(requests);
+        return 1;
+    }
+
+    if (missRatioCurve)
+    {
+        struct MissRatioPoint* points = malloc(cacheLines * sizeof(struct MissRatioPoint));
+        if (!points)
+        {
+            fprintf(stderr, "Failed to allocate the miss-ratio curve.\n");
+            freeRequests(requests);
+            return 1;
+        }
+        run_miss_ratio_curve(&config, num_Requests, requests, points);
+
+        printf("Miss-Ratio Curve:\n");
+        printf("Cache Lines,Hits,Misses,Miss Ratio,Cycles\n");
+        for (unsigned i = 0; i < cacheLines; i++)
+        {
+            printf("%u,%zu,%zu,%.4f,%zu\n", points[i].cacheLines, points[i].hits, points[i].misses,
+                   num_Requests ? (double)points[i].misses / num_Requests : 0.0, points[i].cycles);
+        }
+
+        free(points);
+        freeRequests(requests);
+        return 0;
+    }
+
+    if (sweep)
+    {
+        // Parameters that are not swept keep their single value
+        if (!numSweepLines)
+        {
+            sweepLines[numSweepLines++] = cacheLines;
+        }
+        if (!numSweepLineSizes)
+        {
+            sweepLineSizes[numSweepLineSizes++] = cacheLineSize;
+        }
+        if (!numSweepWays)
+        {
+            sweepWays[numSweepWays++] = directMapped ? 1 : ways;
+        }
+        if (!numSweepCacheLatencies)
+        {
+            sweepCacheLatencies[numSweepCacheLatencies++] = cacheLatency;
+        }
+        if (!numSweepMemoryLatencies)
+        {
+            sweepMemoryLatencies[numSweepMemoryLatencies++] = memoryLatency;
+        }
+
+        const size_t maxConfigs = (size_t)numSweepLines * numSweepLineSizes * numSweepWays * numSweepCacheLatencies
+                                  * numSweepMemoryLatencies;
+        struct SimulationConfig* configs = malloc(maxConfigs * sizeof(struct SimulationConfig));
+        struct Result* results = malloc(maxConfigs * sizeof(struct Result));
+        int* succeeded = malloc(maxConfigs * sizeof(int));
+        if (!configs || !results || !succeeded)
+        {
+            fprintf(stderr, "Failed to allocate %zu sweep configurations.\n", maxConfigs);
+            return 1;
+        }
+
+        // Every combination that describes a valid hierarchy, L2 and below stay as configured
+        size_t numConfigs = 0;
+        for (unsigned a = 0; a < numSweepLineSizes; a++)
+            for (unsigned b = 0; b < numSweepLines; b++)
+                for (unsigned c = 0; c < numSweepWays; c++)
+                    for (unsigned d = 0; d < numSweepCacheLatencies; d++)
+                        for (unsigned e = 0; e < numSweepMemoryLatencies; e++)
+                        {
+                            struct SimulationConfig* sweepConfig = &configs[numConfigs];
+                            *sweepConfig = config;
+                            sweepConfig->memoryLatency = sweepMemoryLatencies[e];
+                            sweepConfig->levels[0].cacheLines = sweepLines[b];
+                            sweepConfig->levels[0].cacheLineSize = sweepLineSizes[a];
+                            sweepConfig->levels[0].ways = sweepWays[c] != 0 ? sweepWays[c] : sweepLines[b];
+                            sweepConfig->levels[0].latency = sweepCacheLatencies[d];
+
+                            int valid = 1;
+                            for (unsigned i = 0; i < sweepConfig->numLevels && valid; i++)
+                            {
+                                valid = validateCacheLevel(&sweepConfig->levels[i], i + 1, policy) == 0
+                                        && (inclusion != INCLUSION_EXCLUSIVE
+                                            || sweepConfig->levels[i].cacheLineSize == sweepLineSizes[a]);
+                            }
+                            if (valid)
+                            {
+                                numConfigs++;
+                            }
+                            else
+                            {
+                                fprintf(stderr, "Skipping %u lines of %u bytes with %u ways\n", sweepLines[b],
+                                        sweepLineSizes[a], sweepConfig->levels[0].ways);
+                            }
+                        }
+
+        if (numConfigs == 0)
+        {
+            fprintf(stderr, "There is no valid sweep configuration.\n");
+            free(configs);
+            free(results);
+            free(succeeded);
+            freeRequests(requests);
+            return 1;
+        }
+
+        // sysconf reports -1 if the number of cores is unknown, the sweep then runs in one worker
+        if (jobs <= 0)
+        {
+            jobs = 1;
+        }
+
+        if (runSweep(configs, numConfigs, requests, num_Requests, (unsigned)jobs, results, succeeded) != 0)
+        {
+            free(configs);
+            free(results);
+            free(succeeded);
+            freeRequests(requests);
+            return 1;
+        }
+
+        printf("Sweep Results:\n");
+        printf("Cache Lines,Line Size,Ways,Cache Latency,Memory Latency,Cycles,Hits,Misses,Primitive Gate Count,"
+               "AMAT\n");
+        for (size_t i = 0; i < numConfigs; i++)
+        {
+            const struct CacheLevelConfig* level = &configs[i].levels[0];
+            printf("%u,%u,%u,%u,%u,", level->cacheLines, level->cacheLineSize, level->ways, level->latency,
+                   configs[i].memoryLatency);
+            if (succeeded[i])
+            {
+                printf("%zu,%zu,%zu,%zu,%.2f\n", results[i].cycles, results[i].hits, results[i].misses,
+                       results[i].primitiveGateCount, results[i].amat);
+            }
+            else
+            {
+                printf("failed\n");
+            }
+        }
+
+        free(configs);
+        free(results);
+        free(succeeded);
+        freeRequests(requests);
+        return 0;
+    }
+
+    // The requests go to the event log, --tf exports them as a VCD from a temporary one
+    FILE* eventLog = NULL;
+    if (eventLogPath || tracefile)
+    {
+        eventLog = openEventLog(eventLogPath);
+        if (!eventLog)
+        {
+            freeRequests(requests);
+            return 1;
+        }
+        config.eventLog = eventLog;
+        config.eventFilter = eventFilter;
+    }
+
+    // Simulation
+    struct Result result;
+    if (stream)
+    {
+        input_file_path = argv[optind];
+        TraceStream* traceStream = openTraceStream(input_file_path);
+        result = run_streaming_simulation(&config, readTraceStream, traceStream);
+        num_Requests = closeTraceStream(traceStream);
+        if (num_Requests == 0)
+        {
+            printf("No requests fetched or an error occurred.\n");
+            return 1;
+        }
+    }
+    else
+    {
+        result = run_simulation_with_config(&config, num_Requests, requests, NULL);
+    }
+    if (eventLog)
+    {
+        size_t exported = 0;
+        const int failed = finishEventLog(eventLog, result.loggedEvents) != 0 ||
+                           (tracefile && exportEventLogVcd(eventLog, tracefile, &exported) != 0);
+        fclose(eventLog);
+        if (failed)
+        {
+            freeRequests(requests);
+            return 1;
+        }
+    }
+
+    // Results, the requests only on request
+    writeSummary(stdout, summaryFormat, &config, &result, num_Requests, eventLogPath || tracefile);
+    if (dumpPath && dumpRequests(dumpPath, dumpFormat, requests, num_Requests) != 0)
+    {
+        freeRequests(requests);
+        return 1;
     }
 
-    free(requests);
+    freeRequests(requests);
     return 0;
 }
@@ -0,0 +1,512 @@
+#include "output.h"
+#include "record_file.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REQUEST_DUMP_MAGIC "CSRD"
+#define REQUEST_DUMP_VERSION 1
+#define DUMP_BUFFER_SIZE (1u << 20) // Bytes of text collected before they are written
+#define MAX_DUMP_LINE 96 // Longest line of a text dump, "Request <20 digits>: Addr = <10 digits>, ..."
+
+// Header of a binary request dump, the requests follow it
+struct RequestDumpHeader
+{
+    struct RecordFileHeader common; // Records are struct Request, their reserved bytes are 0
+    uint64_t numRequests;
+    uint64_t reserved;
+};
+
+_Static_assert(sizeof(struct RequestDumpHeader) == 32, "the request dump header has a fixed layout");
+
+/*
+    Divides two counters
+    parameters:
+        part: the dividend
+        whole: the divisor
+    returns: part / whole, 0 if whole is 0
+*/
+static double rate(size_t part, size_t whole)
+{
+    return whole != 0 ? (double)part / whole : 0.0;
+}
+
+/*
+    Smallest latency counted in a bucket of the latency histogram, see struct RequestStats
+    parameters:
+        bucket: the bucket
+    returns: the latency
+*/
+static size_t latencyBucketLow(unsigned bucket)
+{
+    const unsigned subBuckets = 1u << LATENCY_SUB_BITS;
+    if (bucket < subBuckets)
+    {
+        return bucket;
+    }
+    return (size_t)(subBuckets + (bucket & (subBuckets - 1))) << ((bucket >> LATENCY_SUB_BITS) - 1);
+}
+
+/*
+    Writes the summary as the lines printed for reading
+    parameters:
+        file: the file to write to
+        config: configuration of the run
+        result: result of the run
+        numRequests: number of requests simulated
+        logged: whether the requests were logged
+    returns: -
+*/
+static void writeTextSummary(FILE* file, const struct SimulationConfig* config, const struct Result* result,
+                             size_t numRequests, int logged)
+{
+    const struct RequestStats* stats = &result->stats;
+    fprintf(file, "Simulation Results:\n");
+    fprintf(file, "Cycles: %zu\n", result->cycles);
+    fprintf(file, "Misses: %zu\n", result->misses);
+    fprintf(file, "Hits: %zu\n", result->hits);
+    fprintf(file, "Primitive Gate Count: %zu\n", result->primitiveGateCount);
+    fprintf(file, "Number of Requests: %zu\n", numRequests);
+    if (logged)
+    {
+        fprintf(file, "Logged Events: %zu\n", result->loggedEvents);
+    }
+    for (unsigned i = 0; i < result->numLevels; i++)
+    {
+        fprintf(file, "L%u: Hits: %zu, Misses: %zu, Back-Invalidations: %zu, AMAT: %.2f\n", i + 1,
+                result->levels[i].hits, result->levels[i].misses, result->levels[i].backInvalidations,
+                result->levels[i].amat);
+    }
+    fprintf(file, "AMAT: %.2f\n", result->amat);
+    fprintf(file, "Memory Reads: %zu, Memory Writes: %zu, Write-Backs: %zu\n", result->memoryReads,
+            result->memoryWrites, result->writebacks);
+    fprintf(file, "Reads: %zu, Read Hit Rate: %.2f%%, Writes: %zu, Write Hit Rate: %.2f%%\n", stats->reads,
+            100.0 * rate(stats->readHits, stats->reads), stats->writes, 100.0 * rate(stats->writeHits, stats->writes));
+    fprintf(file, "Latency: Mean: %.2f, P50: %zu, P90: %zu, P99: %zu, Max: %zu\n",
+            rate(stats->totalLatency, stats->reads + stats->writes), stats->latencyP50, stats->latencyP90,
+            stats->latencyP99, stats->maxLatency);
+    fprintf(file, "Cold Lines: %zu, Evictions:", stats->coldLines);
+    for (unsigned i = 0; i < result->numLevels; i++)
+    {
+        fprintf(file, "%s L%u: %zu", i != 0 ? "," : "", i + 1, result->levels[i].evictions);
+    }
+    fprintf(file, "\n");
+    if (config->dram.channels != 0 && result->dram.accesses != 0)
+    {
+        fprintf(file, "DRAM: Accesses: %zu, Row-Hit Rate: %.2f%%, Row Conflicts: %zu, Average Queueing Delay: %.2f\n",
+                result->dram.accesses, 100.0 * result->dram.rowHits / result->dram.accesses,
+                result->dram.rowConflicts, (double)result->dram.queueCycles / result->dram.accesses);
+    }
+    if (config->mshrs != 0)
+    {
+        fprintf(file, "MSHR Merges: %zu, MSHR Stall Cycles: %zu\n", result->mshrMerges, result->mshrStallCycles);
+    }
+    if (config->prefetcher != PREFETCH_NONE)
+    {
+        fprintf(file, "Prefetches: Issued: %zu, Useful: %zu, Late: %zu, Polluting: %zu\n", result->prefetchIssued,
+                result->prefetchUseful, result->prefetchLate, result->prefetchPolluting);
+    }
+    if (config->victimEntries != 0)
+    {
+        fprintf(file, "Victim Cache: Hits: %zu, Misses: %zu, Swaps: %zu\n", result->victimHits, result->victimMisses,
+                result->victimSwaps);
+    }
+
+    if (result->numCores > 1)
+    {
+        fprintf(file, "Cores: %u, Protocol: %s, Interconnect: %s\n", result->numCores,
+                config->coherence == COHERENCE_MOESI ? "MOESI" : "MESI",
+                config->interconnect == INTERCONNECT_BUS ? "bus" : "directory");
+        for (unsigned i = 0; i < result->numCores; i++)
+        {
+            fprintf(file, "Core %u: Cycles: %zu\n", i, result->coreCycles[i]);
+        }
+        fprintf(file, "Coherence Messages: %zu, Invalidations: %zu, False-Sharing Invalidations: %zu, "
+                "Cache-to-Cache Transfers: %zu\n", result->coherenceMessages, result->invalidations,
+                result->falseSharingInvalidations, result->cacheToCacheTransfers);
+        for (unsigned i = 0; i < result->numHotLines; i++)
+        {
+            fprintf(file, "Hot Line 0x%08x: Invalidations: %zu, False Sharing: %zu\n", result->hotLines[i].addr,
+                    result->hotLines[i].invalidations, result->hotLines[i].falseSharing);
+        }
+    }
+}
+
+/*
+    Writes the request statistics as the "statistics" member of the JSON summary, the histogram lists the buckets
+    holding requests with the smallest and largest latency they count
+    parameters:
+        file: the file to write to
+        stats: the statistics
+    returns: -
+*/
+static void writeJsonStatistics(FILE* file, const struct RequestStats* stats)
+{
+    fprintf(file, ",\n  \"statistics\": {\n");
+    fprintf(file, "    \"reads\": %zu,\n    \"readHits\": %zu,\n    \"readHitRate\": %.4f,\n", stats->reads,
+            stats->readHits, rate(stats->readHits, stats->reads));
+    fprintf(file, "    \"writes\": %zu,\n    \"writeHits\": %zu,\n    \"writeHitRate\": %.4f,\n", stats->writes,
+            stats->writeHits, rate(stats->writeHits, stats->writes));
+    fprintf(file, "    \"coldLines\": %zu,\n", stats->coldLines);
+    fprintf(file, "    \"latency\": {\n      \"mean\": %.4f,\n      \"p50\": %zu,\n      \"p90\": %zu,\n"
+            "      \"p99\": %zu,\n      \"max\": %zu,\n      \"histogram\": [",
+            rate(stats->totalLatency, stats->reads + stats->writes), stats->latencyP50, stats->latencyP90,
+            stats->latencyP99, stats->maxLatency);
+    int first = 1;
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        if (stats->latencyHistogram[i] != 0)
+        {
+            const size_t high = i + 1 < LATENCY_BUCKETS ? latencyBucketLow(i + 1) - 1 : SIZE_MAX;
+            fprintf(file, "%s\n        {\"low\": %zu, \"high\": %zu, \"count\": %zu}", first ? "" : ",",
+                    latencyBucketLow(i), high, stats->latencyHistogram[i]);
+            first = 0;
+        }
+    }
+    fprintf(file, "%s]\n    },\n", first ? "" : "\n      ");
+    fprintf(file, "    \"intervals\": {\n      \"requests\": %zu,\n      \"hitRates\": [",
+            stats->intervalRequests);
+    for (unsigned i = 0; i < stats->numIntervals; i++)
+    {
+        fprintf(file, "%s%.4f", i == 0 ? "" : i % 8 == 0 ? ",\n        " : ", ",
+                rate(stats->intervals[i].hits, stats->intervals[i].requests));
+    }
+    fprintf(file, "]\n    }\n  }");
+}
+
+/*
+    Writes the summary as one JSON object, the optional sections are present under the same conditions as their lines
+    in the text summary
+    parameters:
+        file: the file to write to
+        config: configuration of the run
+        result: result of the run
+        numRequests: number of requests simulated
+        logged: whether the requests were logged
+    returns: -
+*/
+static void writeJsonSummary(FILE* file, const struct SimulationConfig* config, const struct Result* result,
+                             size_t numRequests, int logged)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"cycles\": %zu,\n", result->cycles);
+    fprintf(file, "  \"misses\": %zu,\n", result->misses);
+    fprintf(file, "  \"hits\": %zu,\n", result->hits);
+    fprintf(file, "  \"primitiveGateCount\": %zu,\n", result->primitiveGateCount);
+    fprintf(file, "  \"requests\": %zu,\n", numRequests);
+    if (logged)
+    {
+        fprintf(file, "  \"loggedEvents\": %zu,\n", result->loggedEvents);
+    }
+    fprintf(file, "  \"levels\": [");
+    for (unsigned i = 0; i < result->numLevels; i++)
+    {
+        fprintf(file, "%s\n    {\"hits\": %zu, \"misses\": %zu, \"backInvalidations\": %zu, \"evictions\": %zu, "
+                "\"amat\": %.4f}", i != 0 ? "," : "", result->levels[i].hits, result->levels[i].misses,
+                result->levels[i].backInvalidations, result->levels[i].evictions, result->levels[i].amat);
+    }
+    fprintf(file, "\n  ],\n");
+    fprintf(file, "  \"amat\": %.4f,\n", result->amat);
+    fprintf(file, "  \"memoryReads\": %zu,\n", result->memoryReads);
+    fprintf(file, "  \"memoryWrites\": %zu,\n", result->memoryWrites);
+    fprintf(file, "  \"writebacks\": %zu", result->writebacks);
+    if (config->dram.channels != 0 && result->dram.accesses != 0)
+    {
+        fprintf(file, ",\n  \"dram\": {\"accesses\": %zu, \"rowHitRate\": %.4f, \"rowConflicts\": %zu, "
+                "\"averageQueueingDelay\": %.4f}", result->dram.accesses,
+                (double)result->dram.rowHits / result->dram.accesses, result->dram.rowConflicts,
+                (double)result->dram.queueCycles / result->dram.accesses);
+    }
+    if (config->mshrs != 0)
+    {
+        fprintf(file, ",\n  \"mshr\": {\"merges\": %zu, \"stallCycles\": %zu}", result->mshrMerges,
+                result->mshrStallCycles);
+    }
+    if (config->prefetcher != PREFETCH_NONE)
+    {
+        fprintf(file, ",\n  \"prefetch\": {\"issued\": %zu, \"useful\": %zu, \"late\": %zu, \"polluting\": %zu}",
+                result->prefetchIssued, result->prefetchUseful, result->prefetchLate, result->prefetchPolluting);
+    }
+    if (config->victimEntries != 0)
+    {
+        fprintf(file, ",\n  \"victimCache\": {\"hits\": %zu, \"misses\": %zu, \"swaps\": %zu}", result->victimHits,
+                result->victimMisses, result->victimSwaps);
+    }
+    if (result->numCores > 1)
+    {
+        fprintf(file, ",\n  \"coherence\": {\n    \"protocol\": \"%s\",\n    \"interconnect\": \"%s\",\n",
+                config->coherence == COHERENCE_MOESI ? "MOESI" : "MESI",
+                config->interconnect == INTERCONNECT_BUS ? "bus" : "directory");
+        fprintf(file, "    \"coreCycles\": [");
+        for (unsigned i = 0; i < result->numCores; i++)
+        {
+            fprintf(file, "%s%zu", i != 0 ? ", " : "", result->coreCycles[i]);
+        }
+        fprintf(file, "],\n    \"messages\": %zu,\n    \"invalidations\": %zu,\n", result->coherenceMessages,
+                result->invalidations);
+        fprintf(file, "    \"falseSharingInvalidations\": %zu,\n    \"cacheToCacheTransfers\": %zu,\n",
+                result->falseSharingInvalidations, result->cacheToCacheTransfers);
+        fprintf(file, "    \"hotLines\": [");
+        for (unsigned i = 0; i < result->numHotLines; i++)
+        {
+            fprintf(file, "%s\n      {\"addr\": %u, \"invalidations\": %zu, \"falseSharing\": %zu}",
+                    i != 0 ? "," : "", result->hotLines[i].addr, result->hotLines[i].invalidations,
+                    result->hotLines[i].falseSharing);
+        }
+        fprintf(file, "%s]\n  }", result->numHotLines != 0 ? "\n    " : "");
+    }
+    writeJsonStatistics(file, &result->stats);
+    fprintf(file, "\n}\n");
+}
+
+/*
+    Writes the summary as a CSV header line and one line of values, the per level, per core and optional columns are
+    present under the same conditions as their lines in the text summary
+    parameters:
+        file: the file to write to
+        config: configuration of the run
+        result: result of the run
+        numRequests: number of requests simulated
+        logged: whether the requests were logged
+    returns: -
+*/
+static void writeCsvSummary(FILE* file, const struct SimulationConfig* config, const struct Result* result,
+                            size_t numRequests, int logged)
+{
+    const struct RequestStats* stats = &result->stats;
+    const int dram = config->dram.channels != 0 && result->dram.accesses != 0;
+
+    fprintf(file, "Cycles,Misses,Hits,Primitive Gate Count,Number of Requests");
+    if (logged)
+    {
+        fprintf(file, ",Logged Events");
+    }
+    for (unsigned i = 0; i < result->numLevels; i++)
+    {
+        fprintf(file, ",L%u Hits,L%u Misses,L%u Back-Invalidations,L%u Evictions,L%u AMAT", i + 1, i + 1, i + 1,
+                i + 1, i + 1);
+    }
+    fprintf(file, ",AMAT,Memory Reads,Memory Writes,Write-Backs,Read Hit Rate,Write Hit Rate,Cold Lines,"
+            "Mean Latency,P50 Latency,P90 Latency,P99 Latency,Max Latency");
+    if (dram)
+    {
+        fprintf(file, ",DRAM Accesses,DRAM Row-Hit Rate,DRAM Row Conflicts,DRAM Average Queueing Delay");
+    }
+    if (config->mshrs != 0)
+    {
+        fprintf(file, ",MSHR Merges,MSHR Stall Cycles");
+    }
+    if (config->prefetcher != PREFETCH_NONE)
+    {
+        fprintf(file, ",Prefetches Issued,Prefetches Useful,Prefetches Late,Prefetches Polluting");
+    }
+    if (config->victimEntries != 0)
+    {
+        fprintf(file, ",Victim Hits,Victim Misses,Victim Swaps");
+    }
+    if (result->numCores > 1)
+    {
+        for (unsigned i = 0; i < result->numCores; i++)
+        {
+            fprintf(file, ",Core %u Cycles", i);
+        }
+        fprintf(file, ",Coherence Messages,Invalidations,False-Sharing Invalidations,Cache-to-Cache Transfers");
+    }
+    fprintf(file, "\n");
+
+    fprintf(file, "%zu,%zu,%zu,%zu,%zu", result->cycles, result->misses, result->hits, result->primitiveGateCount,
+            numRequests);
+    if (logged)
+    {
+        fprintf(file, ",%zu", result->loggedEvents);
+    }
+    for (unsigned i = 0; i < result->numLevels; i++)
+    {
+        fprintf(file, ",%zu,%zu,%zu,%zu,%.4f", result->levels[i].hits, result->levels[i].misses,
+                result->levels[i].backInvalidations, result->levels[i].evictions, result->levels[i].amat);
+    }
+    fprintf(file, ",%.4f,%zu,%zu,%zu", result->amat, result->memoryReads, result->memoryWrites, result->writebacks);
+    fprintf(file, ",%.4f,%.4f,%zu,%.4f,%zu,%zu,%zu,%zu", rate(stats->readHits, stats->reads),
+            rate(stats->writeHits, stats->writes), stats->coldLines,
+            rate(stats->totalLatency, stats->reads + stats->writes), stats->latencyP50, stats->latencyP90,
+            stats->latencyP99, stats->maxLatency);
+    if (dram)
+    {
+        fprintf(file, ",%zu,%.4f,%zu,%.4f", result->dram.accesses, (double)result->dram.rowHits / result->dram.accesses,
+                result->dram.rowConflicts, (double)result->dram.queueCycles / result->dram.accesses);
+    }
+    if (config->mshrs != 0)
+    {
+        fprintf(file, ",%zu,%zu", result->mshrMerges, result->mshrStallCycles);
+    }
+    if (config->prefetcher != PREFETCH_NONE)
+    {
+        fprintf(file, ",%zu,%zu,%zu,%zu", result->prefetchIssued, result->prefetchUseful, result->prefetchLate,
+                result->prefetchPolluting);
+    }
+    if (config->victimEntries != 0)
+    {
+        fprintf(file, ",%zu,%zu,%zu", result->victimHits, result->victimMisses, result->victimSwaps);
+    }
+    if (result->numCores > 1)
+    {
+        for (unsigned i = 0; i < result->numCores; i++)
+        {
+            fprintf(file, ",%zu", result->coreCycles[i]);
+        }
+        fprintf(file, ",%zu,%zu,%zu,%zu", result->coherenceMessages, result->invalidations,
+                result->falseSharingInvalidations, result->cacheToCacheTransfers);
+    }
+    fprintf(file, "\n");
+}
+
+/*
+    Writes the summary of a run
+    parameters:
+        file: the file to write to
+        format: the format (enum SummaryFormat)
+        config: configuration of the run, decides which of the optional statistics are reported
+        result: result of the run
+        numRequests: number of requests simulated
+        logged: whether the requests were logged, reports the number of logged events
+    returns: -
+*/
+void writeSummary(FILE* file, int format, const struct SimulationConfig* config, const struct Result* result,
+                  size_t numRequests, int logged)
+{
+    switch (format)
+    {
+    case SUMMARY_JSON:
+        writeJsonSummary(file, config, result, numRequests, logged);
+        break;
+    case SUMMARY_CSV:
+        writeCsvSummary(file, config, result, numRequests, logged);
+        break;
+    default:
+        writeTextSummary(file, config, result, numRequests, logged);
+        break;
+    }
+}
+
+/*
+    Appends the decimal digits of a number
+    parameters:
+        text: where to write them
+        value: the number
+    returns: the first byte after the digits
+*/
+static char* appendDecimal(char* text, uint64_t value)
+{
+    char digits[20];
+    unsigned count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+    while (count > 0)
+    {
+        *text++ = digits[--count];
+    }
+    return text;
+}
+
+/*
+    Appends a string without its terminator
+    parameters:
+        text: where to write it
+        string: the string
+    returns: the first byte after it
+*/
+static char* appendString(char* text, const char* string)
+{
+    const size_t length = strlen(string);
+    memcpy(text, string, length);
+    return text + length;
+}
+
+/*
+    Writes the requests as lines "Request <i>: Addr = <addr>, Data = <data>, WE = <we>", formatted by hand into a
+    large buffer that is written whenever it fills up
+    parameters:
+        file: the file to write to
+        requests: the requests
+        numRequests: number of requests
+    returns: 0 on success, -1 if writing failed
+*/
+static int dumpRequestsText(FILE* file, const struct Request* requests, size_t numRequests)
+{
+    char* buffer = malloc(DUMP_BUFFER_SIZE);
+    if (!buffer)
+    {
+        return -1;
+    }
+    char* end = buffer;
+    int failed = 0;
+    for (size_t i = 0; i < numRequests && !failed; i++)
+    {
+        end = appendString(end, "Request ");
+        end = appendDecimal(end, i);
+        end = appendString(end, ": Addr = ");
+        end = appendDecimal(end, requests[i].addr);
+        end = appendString(end, ", Data = ");
+        end = appendDecimal(end, requests[i].data);
+        end = appendString(end, ", WE = ");
+        end = appendDecimal(end, requests[i].we);
+        *end++ = '\n';
+        if ((size_t)(end - buffer) > DUMP_BUFFER_SIZE - MAX_DUMP_LINE || i + 1 == numRequests)
+        {
+            failed = fwrite(buffer, 1, (size_t)(end - buffer), file) != (size_t)(end - buffer);
+            end = buffer;
+        }
+    }
+    free(buffer);
+    return failed ? -1 : 0;
+}
+
+/*
+    Writes the requests of a run to a file
+    parameters:
+        path: path to the file to create
+        format: the format (enum DumpFormat)
+        requests: the requests, with the data read by the simulation
+        numRequests: number of requests
+    returns: 0 on success, -1 with an error message if the file cannot be written
+*/
+int dumpRequests(const char* path, int format, const struct Request* requests, size_t numRequests)
+{
+    FILE* file = fopen(path, format == DUMP_BINARY ? "wb" : "w");
+    if (!file)
+    {
+        fprintf(stderr, "Error creating file: %s\n", path);
+        return -1;
+    }
+    // The dump is written in large blocks of its own, the stdio buffer would only copy them once more
+    setvbuf(file, NULL, _IONBF, 0);
+
+    int failed;
+    if (format == DUMP_BINARY)
+    {
+        struct RequestDumpHeader header;
+        memset(&header, 0, sizeof(header));
+        initRecordFileHeader(&header.common, REQUEST_DUMP_MAGIC, REQUEST_DUMP_VERSION, sizeof(struct Request));
+        header.numRequests = numRequests;
+        failed = fwrite(&header, sizeof(header), 1, file) != 1 ||
+                 fwrite(requests, sizeof(struct Request), numRequests, file) != numRequests;
+    }
+    else
+    {
+        failed = dumpRequestsText(file, requests, numRequests) != 0;
+    }
+    if (ferror(file) | (fclose(file) != 0))
+    {
+        failed = 1;
+    }
+    if (failed)
+    {
+        fprintf(stderr, "Error writing file: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "simulation.h"
+
+/*
+    Output of simulation runs.
+
+    A run prints a summary of its Result, as text for reading or as JSON or CSV for scripts. The requests with the data
+    read by the simulation are only written on request, into a file of their own: as text, one line per request, or as
+    a binary dump, a 32 byte header followed by the requests exactly as struct Request is laid out in memory.
+*/
+
+// Formats of the summary
+enum SummaryFormat
+{
+    SUMMARY_TEXT,
+    SUMMARY_JSON,
+    SUMMARY_CSV
+};
+
+// Formats of the request dump
+enum DumpFormat
+{
+    DUMP_TEXT,
+    DUMP_BINARY
+};
+
+/*
+    Writes the summary of a run
+    parameters:
+        file: the file to write to
+        format: the format (enum SummaryFormat)
+        config: configuration of the run, decides which of the optional statistics are reported
+        result: result of the run
+        numRequests: number of requests simulated
+        logged: whether the requests were logged, reports the number of logged events
+    returns: -
+*/
+void writeSummary(FILE* file, int format, const struct SimulationConfig* config, const struct Result* result,
+                  size_t numRequests, int logged);
+
+/*
+    Writes the requests of a run to a file
+    parameters:
+        path: path to the file to create
+        format: the format (enum DumpFormat)
+        requests: the requests, with the data read by the simulation
+        numRequests: number of requests
+    returns: 0 on success, -1 with an error message if the file cannot be written
+*/
+int dumpRequests(const char* path, int format, const struct Request* requests, size_t numRequests);
+
+#endif // OUTPUT_H
@@ -0,0 +1,65 @@
+#include "parallel.h"
+#include <stdlib.h>
+
+/*
+    Starts a function on every job of an array, each on its own thread
+    parameters:
+        jobs: the jobs, numJobs elements of jobSize bytes
+        numJobs: number of jobs
+        jobSize: size of a job
+        function: the function, called with a pointer to its job
+        threads: receives the threads started, room for numJobs, NULL runs every job on the calling thread
+    returns: number of threads started, they run the first jobs, the others have run here when it returns
+*/
+size_t startJobs(void* jobs, size_t numJobs, size_t jobSize, void* (*function)(void*), pthread_t* threads)
+{
+    char* job = jobs;
+    size_t started = 0;
+    while (threads && started < numJobs && pthread_create(&threads[started], NULL, function, job) == 0)
+    {
+        started++;
+        job += jobSize;
+    }
+    for (size_t i = started; i < numJobs; i++, job += jobSize) // Not enough threads, the rest runs here
+    {
+        function(job);
+    }
+    return started;
+}
+
+/*
+    Waits for the threads started by startJobs
+    parameters:
+        threads: the threads
+        numThreads: number of threads started
+    returns: -
+*/
+void joinJobs(const pthread_t* threads, size_t numThreads)
+{
+    for (size_t i = 0; i < numThreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/*
+    Runs a function on every job of an array and waits for all of them, the calling thread runs the first job
+    parameters:
+        jobs: the jobs, numJobs elements of jobSize bytes
+        numJobs: number of jobs
+        jobSize: size of a job
+        function: the function, called with a pointer to its job
+    returns: -
+*/
+void runJobs(void* jobs, size_t numJobs, size_t jobSize, void* (*function)(void*))
+{
+    if (numJobs == 0)
+    {
+        return;
+    }
+    pthread_t* threads = numJobs > 1 ? malloc((numJobs - 1) * sizeof(pthread_t)) : NULL;
+    const size_t started = startJobs((char*)jobs + jobSize, numJobs - 1, jobSize, function, threads);
+    function(jobs);
+    joinJobs(threads, started);
+    free(threads);
+}
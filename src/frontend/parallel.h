@@ -0,0 +1,47 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+/*
+    Fan-out of an array of jobs over threads.
+
+    Every job runs a function on its own thread. A job that does not get a thread (the system is out of threads, or
+    there is no room to remember them) runs on the calling thread instead, so the jobs always all run, only with less
+    parallelism.
+*/
+
+/*
+    Starts a function on every job of an array, each on its own thread
+    parameters:
+        jobs: the jobs, numJobs elements of jobSize bytes
+        numJobs: number of jobs
+        jobSize: size of a job
+        function: the function, called with a pointer to its job
+        threads: receives the threads started, room for numJobs, NULL runs every job on the calling thread
+    returns: number of threads started, they run the first jobs, the others have run here when it returns
+*/
+size_t startJobs(void* jobs, size_t numJobs, size_t jobSize, void* (*function)(void*), pthread_t* threads);
+
+/*
+    Waits for the threads started by startJobs
+    parameters:
+        threads: the threads
+        numThreads: number of threads started
+    returns: -
+*/
+void joinJobs(const pthread_t* threads, size_t numThreads);
+
+/*
+    Runs a function on every job of an array and waits for all of them, the calling thread runs the first job
+    parameters:
+        jobs: the jobs, numJobs elements of jobSize bytes
+        numJobs: number of jobs
+        jobSize: size of a job
+        function: the function, called with a pointer to its job
+    returns: -
+*/
+void runJobs(void* jobs, size_t numJobs, size_t jobSize, void* (*function)(void*));
+
+#endif // PARALLEL_H
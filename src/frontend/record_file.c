@@ -0,0 +1,58 @@
+#include "record_file.h"
+#include <stdio.h>
+#include <string.h>
+
+#define RECORD_FILE_BYTE_ORDER 0x01020304u
+
+/*
+    Fills in the header of a record file
+    parameters:
+        header: the header
+        magic: the 4 characters naming the format
+        version: version of the format
+        recordSize: size of a record
+    returns: -
+*/
+void initRecordFileHeader(struct RecordFileHeader* header, const char* magic, uint32_t version, uint32_t recordSize)
+{
+    memcpy(header->magic, magic, sizeof(header->magic));
+    header->byteOrder = RECORD_FILE_BYTE_ORDER;
+    header->version = version;
+    header->recordSize = recordSize;
+}
+
+/*
+    Checks that a header was written by this build for a format
+    parameters:
+        header: the header read from the file
+        magic: the 4 characters naming the format
+        version: version of the format
+        recordSize: size of a record
+    returns: 0 if the records can be read as they are, -1 otherwise
+*/
+int checkRecordFileHeader(const struct RecordFileHeader* header, const char* magic, uint32_t version,
+                          uint32_t recordSize)
+{
+    return memcmp(header->magic, magic, sizeof(header->magic)) == 0 && header->byteOrder == RECORD_FILE_BYTE_ORDER &&
+           header->version == version && header->recordSize == recordSize ? 0 : -1;
+}
+
+/*
+    Checks whether a file starts with the magic of a format
+    parameters:
+        path: path to the file
+        magic: the 4 characters naming the format
+    returns: 1 if it does, 0 otherwise (also if it cannot be read)
+*/
+int hasRecordFileMagic(const char* path, const char* magic)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return 0;
+    }
+    char start[4];
+    const int matches = fread(start, 1, sizeof(start), file) == sizeof(start) && memcmp(start, magic, 4) == 0;
+    fclose(file);
+    return matches;
+}
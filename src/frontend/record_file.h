@@ -0,0 +1,56 @@
+#ifndef RECORD_FILE_H
+#define RECORD_FILE_H
+
+#include <stdint.h>
+
+/*
+    Common start of the binary files that hold records exactly as a structure is laid out in memory: trace cache
+    sidecars, event logs and request dumps. The header names the format (magic and version) and identifies the layout
+    of the records (byte order and record size), a file is only read by a build that lays them out the same way. Each
+    format adds its own fields after it.
+*/
+
+// Leading fields of the header of a record file
+struct RecordFileHeader
+{
+    char magic[4];
+    uint32_t byteOrder; // RECORD_FILE_BYTE_ORDER as written by the machine that created the file
+    uint32_t version;
+    uint32_t recordSize; // sizeof the record structure
+};
+
+_Static_assert(sizeof(struct RecordFileHeader) == 16, "the record file header has a fixed layout");
+
+/*
+    Fills in the header of a record file
+    parameters:
+        header: the header
+        magic: the 4 characters naming the format
+        version: version of the format
+        recordSize: size of a record
+    returns: -
+*/
+void initRecordFileHeader(struct RecordFileHeader* header, const char* magic, uint32_t version, uint32_t recordSize);
+
+/*
+    Checks that a header was written by this build for a format
+    parameters:
+        header: the header read from the file
+        magic: the 4 characters naming the format
+        version: version of the format
+        recordSize: size of a record
+    returns: 0 if the records can be read as they are, -1 otherwise
+*/
+int checkRecordFileHeader(const struct RecordFileHeader* header, const char* magic, uint32_t version,
+                          uint32_t recordSize);
+
+/*
+    Checks whether a file starts with the magic of a format
+    parameters:
+        path: path to the file
+        magic: the 4 characters naming the format
+    returns: 1 if it does, 0 otherwise (also if it cannot be read)
+*/
+int hasRecordFileMagic(const char* path, const char* magic);
+
+#endif // RECORD_FILE_H
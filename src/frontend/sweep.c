@@ -0,0 +1,213 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS is not part of POSIX
+
+#include "sweep.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Result slot of one configuration, written by its worker
+struct SweepSlot
+{
+    struct Result result;
+    int done;
+};
+
+/*
+    Parses one item of a sweep value list
+    parameters:
+        item: the item
+        values: array of MAX_SWEEP_VALUES entries receiving the values
+        count: number of values already stored, incremented for every value
+    returns: 0 on success, -1 if the item is malformed or the list too long
+*/
+static int parseSweepItem(const char* item, unsigned* values, unsigned* count)
+{
+    char* end;
+    unsigned long first;
+    unsigned long last;
+    unsigned long step = 1;
+    char op = '+';
+
+    if (!isdigit((unsigned char)item[0]))
+    {
+        return -1;
+    }
+    first = strtoul(item, &end, 10);
+    last = first;
+    if (*end == '-')
+    {
+        const char* lastStart = end + 1;
+        if (!isdigit((unsigned char)*lastStart))
+        {
+            return -1;
+        }
+        last = strtoul(lastStart, &end, 10);
+        if (*end == '+' || *end == '*')
+        {
+            op = *end;
+            const char* stepStart = end + 1;
+            if (!isdigit((unsigned char)*stepStart))
+            {
+                return -1;
+            }
+            step = strtoul(stepStart, &end, 10);
+        }
+    }
+    if (*end != '\0' || last > UINT_MAX || first > last || step == 0 || (op == '*' && (step == 1 || first == 0)))
+    {
+        return -1;
+    }
+
+    for (unsigned long long value = first; value <= last; value = op == '*' ? value * step : value + step)
+    {
+        if (*count >= MAX_SWEEP_VALUES)
+        {
+            return -1;
+        }
+        values[(*count)++] = (unsigned)value;
+    }
+    return 0;
+}
+
+/*
+    Parses the value list of a sweep option
+    parameters:
+        spec: the option argument
+        values: array of MAX_SWEEP_VALUES entries receiving the values
+        count: pointer to where the number of values will be stored
+    returns: 0 on success, -1 if the list is malformed or too long
+*/
+int parseSweepList(const char* spec, unsigned* values, unsigned* count)
+{
+    char* copy = strdup(spec);
+    char* save = NULL;
+    int status = 0;
+
+    *count = 0;
+    for (char* item = strtok_r(copy, ",", &save); item && status == 0; item = strtok_r(NULL, ",", &save))
+    {
+        status = parseSweepItem(item, values, count);
+    }
+    free(copy);
+    return status == 0 && *count > 0 ? 0 : -1;
+}
+
+/*
+    Runs one configuration inside a worker process and never returns
+    parameters:
+        config: the configuration
+        requests: the shared read-only requests
+        numRequests: number of requests
+        slot: the shared slot receiving the result
+*/
+static void runWorker(const struct SimulationConfig* config, const struct Request* requests, size_t numRequests,
+                      struct SweepSlot* slot)
+{
+    // The simulation's own output would interleave with the other workers
+    if (!freopen("/dev/null", "w", stdout))
+    {
+        _exit(1);
+    }
+
+    struct SimulationConfig workerConfig = *config;
+    workerConfig.discardReadData = 1; // The shared requests are mapped read-only
+    slot->result = run_simulation_with_config(&workerConfig, numRequests, (struct Request*)requests, NULL);
+    slot->done = 1;
+    _exit(0);
+}
+
+/*
+    Runs simulations in parallel forked worker processes
+    parameters:
+        configs: the configurations to simulate
+        numConfigs: number of configurations
+        requests: the requests replayed by every configuration, left unchanged
+        numRequests: number of requests
+        jobs: maximum number of workers running at the same time
+        results: array of numConfigs entries receiving the results
+        succeeded: array of numConfigs entries set to 1 if the worker delivered a result and 0 otherwise
+    returns: 0 on success, -1 if the shared memory could not be set up
+*/
+int runSweep(const struct SimulationConfig* configs, size_t numConfigs, const struct Request* requests,
+             size_t numRequests, unsigned jobs, struct Result* results, int* succeeded)
+{
+    const size_t traceBytes = numRequests * sizeof(struct Request);
+    const size_t slotBytes = numConfigs * sizeof(struct SweepSlot);
+
+    // One copy of the trace for all workers, read-only so no worker can modify it or trigger copy-on-write
+    struct Request* sharedRequests = NULL;
+    if (traceBytes > 0)
+    {
+        sharedRequests = mmap(NULL, traceBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (sharedRequests == MAP_FAILED)
+        {
+            perror("mmap");
+            return -1;
+        }
+        memcpy(sharedRequests, requests, traceBytes);
+        mprotect(sharedRequests, traceBytes, PROT_READ);
+    }
+
+    struct SweepSlot* slots = mmap(NULL, slotBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (slots == MAP_FAILED)
+    {
+        perror("mmap");
+        if (sharedRequests)
+        {
+            munmap(sharedRequests, traceBytes);
+        }
+        return -1;
+    }
+    memset(slots, 0, slotBytes);
+
+    fflush(stdout); // Buffered output would otherwise be inherited by every worker
+    unsigned running = 0;
+    size_t next = 0;
+    while (next < numConfigs || running > 0)
+    {
+        while (next < numConfigs && running < jobs)
+        {
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                runWorker(&configs[next], sharedRequests, numRequests, &slots[next]);
+            }
+            if (pid < 0)
+            {
+                perror("fork");
+                break;
+            }
+            running++;
+            next++;
+        }
+
+        if (running == 0) // Not even one worker could be started
+        {
+            break;
+        }
+        while (wait(NULL) < 0 && errno == EINTR)
+        {
+        }
+        running--;
+    }
+
+    for (size_t i = 0; i < numConfigs; i++)
+    {
+        results[i] = slots[i].result;
+        succeeded[i] = slots[i].done;
+    }
+
+    munmap(slots, slotBytes);
+    if (sharedRequests)
+    {
+        munmap(sharedRequests, traceBytes);
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stddef.h>
+
+#include "simulation.h"
+
+#define MAX_SWEEP_VALUES 64 // Maximum number of values of one swept parameter
+
+/*
+    Parses the value list of a sweep option, comma separated items that are either a number or a range
+    "<first>-<last>" counting up by 1, by "+<step>" or multiplying by "*<factor>" (e.g. "16,32", "1-4", "16-1024*2")
+    parameters:
+        spec: the option argument
+        values: array of MAX_SWEEP_VALUES entries receiving the values
+        count: pointer to where the number of values will be stored
+    returns: 0 on success, -1 if the list is malformed or too long
+*/
+int parseSweepList(const char* spec, unsigned* values, unsigned* count);
+
+/*
+    Runs simulations in parallel, each one in its own forked process so every run gets a fresh SystemC kernel.
+    The requests are copied once into read-only shared memory that all workers map, the results come back through
+    a second shared mapping.
+    parameters:
+        configs: the configurations to simulate
+        numConfigs: number of configurations
+        requests: the requests replayed by every configuration, left unchanged
+        numRequests: number of requests
+        jobs: maximum number of workers running at the same time
+        results: array of numConfigs entries receiving the results
+        succeeded: array of numConfigs entries set to 1 if the worker delivered a result and 0 otherwise
+    returns: 0 on success, -1 if the shared memory could not be set up
+*/
+int runSweep(const struct SimulationConfig* configs, size_t numConfigs, const struct Request* requests,
+             size_t numRequests, unsigned jobs, struct Result* results, int* succeeded);
+
+#endif // SWEEP_H
@@ -0,0 +1,217 @@
+#include "trace_cache.h"
+#include "record_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TRACE_CACHE_MAGIC "CSTR"
+#define TRACE_CACHE_VERSION 2 // 1 wrote whatever the padding of struct Request held
+
+// Header of a sidecar, the requests follow it
+struct TraceCacheHeader
+{
+    struct RecordFileHeader common; // Records are struct Request
+    uint64_t numRequests;
+    uint64_t traceSize; // Size of the trace the requests were parsed from
+    uint64_t traceHash; // Hash of the trace's content
+    uint8_t reserved[24];
+};
+
+_Static_assert(sizeof(struct TraceCacheHeader) == 64, "the sidecar header has a fixed layout");
+
+// Mapping holding the requests handed out by loadTraceCache, so freeRequests can tell them apart
+static void* mappedSidecar = NULL;
+static size_t mappedSize = 0;
+
+/*
+    Hashes the content of a file, 8 bytes at a time
+    parameters:
+        path: path to the file
+        size: receives the size of the file
+        hash: receives the hash
+    returns: 0 on success, -1 if the file cannot be read
+*/
+static int hashFile(const char* path, uint64_t* size, uint64_t* hash)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    *size = (uint64_t)info.st_size;
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ *size;
+    if (*size != 0)
+    {
+        const unsigned char* bytes = mmap(NULL, (size_t)*size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (bytes == MAP_FAILED)
+        {
+            close(fd);
+            return -1;
+        }
+        posix_madvise((void*)bytes, (size_t)*size, POSIX_MADV_SEQUENTIAL);
+        size_t i = 0;
+        for (; i + 8 <= *size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(word));
+            h = (h ^ (word * 0xff51afd7ed558ccdull)) * 0xc4ceb9fe1a85ec53ull;
+            h ^= h >> 29;
+        }
+        for (; i < *size; i++)
+        {
+            h = (h ^ bytes[i]) * 0x100000001b3ull;
+        }
+        munmap((void*)bytes, (size_t)*size);
+    }
+    close(fd);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    *hash = h;
+    return 0;
+}
+
+/*
+    Builds the path of the sidecar of a trace
+    parameters:
+        tracePath: path to the trace
+    returns: the path, to be freed by the caller, or NULL
+*/
+static char* sidecarPath(const char* tracePath)
+{
+    size_t length = strlen(tracePath);
+    char* path = malloc(length + sizeof(TRACE_CACHE_SUFFIX));
+    if (path)
+    {
+        memcpy(path, tracePath, length);
+        memcpy(path + length, TRACE_CACHE_SUFFIX, sizeof(TRACE_CACHE_SUFFIX));
+    }
+    return path;
+}
+
+/*
+    Maps the sidecar of a trace if it is up to date
+    parameters:
+        tracePath: path to the trace
+        numRequests pointer to where the number of requests will be stored
+        requests pointer to where the mapped requests will be stored, release them with freeRequests
+    returns: 0 if the sidecar was mapped, -1 if it is missing, stale or unreadable
+*/
+int loadTraceCache(const char* tracePath, size_t* numRequests, struct Request** requests)
+{
+    char* path = sidecarPath(tracePath);
+    int fd = path ? open(path, O_RDONLY) : -1;
+    free(path);
+    struct stat info;
+    struct TraceCacheHeader header;
+    if (fd < 0 || fstat(fd, &info) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    // Check the layout before anything else, then that the trace did not change
+    uint64_t traceSize;
+    uint64_t traceHash;
+    size_t size = (size_t)info.st_size;
+    if (checkRecordFileHeader(&header.common, TRACE_CACHE_MAGIC, TRACE_CACHE_VERSION, sizeof(struct Request)) != 0 ||
+        header.numRequests == 0 || header.numRequests > (SIZE_MAX - sizeof(header)) / sizeof(struct Request) ||
+        size != sizeof(header) + header.numRequests * sizeof(struct Request) ||
+        hashFile(tracePath, &traceSize, &traceHash) != 0 || traceSize != header.traceSize ||
+        traceHash != header.traceHash)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // Private and writable, the simulation may store the data of reads into the requests
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+    mappedSidecar = map;
+    mappedSize = size;
+    *numRequests = (size_t)header.numRequests;
+    *requests = (struct Request*)((char*)map + sizeof(header));
+    return 0;
+}
+
+/*
+    Writes the sidecar of a trace, failing silently if the directory is not writable
+    parameters:
+        tracePath: path to the trace
+        requests: the requests parsed from the trace
+        numRequests: number of requests
+    returns: 0 on success, -1 otherwise
+*/
+int writeTraceCache(const char* tracePath, const struct Request* requests, size_t numRequests)
+{
+    struct TraceCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    initRecordFileHeader(&header.common, TRACE_CACHE_MAGIC, TRACE_CACHE_VERSION, sizeof(struct Request));
+    header.numRequests = numRequests;
+    if (numRequests == 0 || hashFile(tracePath, &header.traceSize, &header.traceHash) != 0)
+    {
+        return -1;
+    }
+
+    // Written under a temporary name and renamed, so no run ever maps a half written sidecar
+    char* path = sidecarPath(tracePath);
+    char* temporary = path ? malloc(strlen(path) + 32) : NULL;
+    if (!temporary)
+    {
+        free(path);
+        return -1;
+    }
+    sprintf(temporary, "%s.%ld", path, (long)getpid());
+    FILE* file = fopen(temporary, "wb");
+    int failed = !file;
+    if (file)
+    {
+        failed |= fwrite(&header, sizeof(header), 1, file) != 1;
+        failed |= fwrite(requests, sizeof(struct Request), numRequests, file) != numRequests;
+        failed |= fclose(file) != 0;
+    }
+    failed = failed || rename(temporary, path) != 0;
+    if (failed)
+    {
+        remove(temporary);
+    }
+#ifdef DEBUG
+    printf(failed ? "Could not write trace cache %s\n" : "Wrote trace cache %s\n", path);
+#endif
+    free(temporary);
+    free(path);
+    return failed ? -1 : 0;
+}
+
+/*
+    Releases requests that were either allocated by a trace reader or mapped by loadTraceCache
+    parameters:
+        requests: the requests (may be NULL)
+    returns: -
+*/
+void freeRequests(struct Request* requests)
+{
+    if (mappedSidecar && (char*)requests == (char*)mappedSidecar + sizeof(struct TraceCacheHeader))
+    {
+        munmap(mappedSidecar, mappedSize);
+        mappedSidecar = NULL;
+        return;
+    }
+    free(requests);
+}
@@ -0,0 +1,48 @@
+#ifndef TRACE_CACHE_H
+#define TRACE_CACHE_H
+
+#include <stddef.h>
+
+#include "simulation.h"
+
+/*
+    Sidecar files caching parsed traces.
+
+    The first run on a csv trace stores its requests next to it in "<trace>.requests": a 64 byte header followed by the
+    request array exactly as struct Request lays it out in memory. The header identifies the layout (record size and
+    byte order) and the trace it was made from (size and a 64 bit hash of its content). Later runs map the sidecar
+    and hand the mapped records to the simulation as they are, pages are only copied if the simulation stores read
+    data into them. Binary traces get no sidecar, they decode quickly and the sidecar would be several times their size.
+*/
+
+#define TRACE_CACHE_SUFFIX ".requests"
+
+/*
+    Maps the sidecar of a trace if it is up to date
+    parameters:
+        tracePath: path to the trace
+        numRequests pointer to where the number of requests will be stored
+        requests pointer to where the mapped requests will be stored, release them with freeRequests
+    returns: 0 if the sidecar was mapped, -1 if it is missing, stale or unreadable
+*/
+int loadTraceCache(const char* tracePath, size_t* numRequests, struct Request** requests);
+
+/*
+    Writes the sidecar of a trace, failing silently if the directory is not writable
+    parameters:
+        tracePath: path to the trace
+        requests: the requests parsed from the trace
+        numRequests: number of requests
+    returns: 0 on success, -1 otherwise
+*/
+int writeTraceCache(const char* tracePath, const struct Request* requests, size_t numRequests);
+
+/*
+    Releases requests that were either allocated by a trace reader or mapped by loadTraceCache
+    parameters:
+        requests: the requests (may be NULL)
+    returns: -
+*/
+void freeRequests(struct Request* requests);
+
+#endif // TRACE_CACHE_H
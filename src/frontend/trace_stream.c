@@ -0,0 +1,208 @@
+#include "trace_stream.h"
+#include "file_processing.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define RING_MASK (TRACE_STREAM_CAPACITY - 1)
+#define SPINS_BEFORE_SLEEP 64 // Yields before a waiting thread starts sleeping
+
+_Static_assert((TRACE_STREAM_CAPACITY & RING_MASK) == 0, "the ring capacity must be a power of two");
+
+struct TraceStream
+{
+    FILE* file;
+    struct Request ring[TRACE_STREAM_CAPACITY];
+    _Alignas(64) _Atomic size_t head; // Requests written by the reader, only the reader stores it
+    _Alignas(64) _Atomic size_t tail; // Requests taken by the simulation, only the simulation stores it
+    _Atomic int finished; // Set by the reader after the last request
+    _Atomic int closed; // Set by closeTraceStream, the reader stops at the next line
+    size_t consumed;
+    pthread_t reader;
+};
+
+/*
+    Waits a little for the other side of the ring, first by yielding and then by sleeping
+    parameters:
+        spins: number of times the caller waited so far, incremented
+    returns: -
+*/
+static void backOff(unsigned* spins)
+{
+    if ((*spins)++ < SPINS_BEFORE_SLEEP)
+    {
+        sched_yield();
+    }
+    else
+    {
+        const struct timespec pause = {0, 50000};
+        nanosleep(&pause, NULL);
+    }
+}
+
+/*
+    Reader thread, parses the trace into the ring until its end or until the stream is closed
+    parameters:
+        arg: the stream
+    returns: NULL
+*/
+static void* readTrace(void* arg)
+{
+    TraceStream* stream = arg;
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t length;
+    size_t lineNumber = 0;
+    size_t head = 0;
+    size_t tail = 0; // Last tail seen, the ring has at least as much room as it suggests
+
+    while (!atomic_load_explicit(&stream->closed, memory_order_relaxed) &&
+           (length = getline(&line, &lineCapacity, stream->file)) != -1)
+    {
+        //Skip first line since it doesn't contain data
+        if (++lineNumber == 1)
+        {
+            continue;
+        }
+        const char* end = line + length;
+        if (end > line && end[-1] == '\n')
+        {
+            end--;
+        }
+        struct Request request;
+        enum ParseError error = parseRequestLine(line, end, &request);
+        if (error != PARSE_OK)
+        {
+            printParseError(error, lineNumber, line, end);
+            exit(1);
+        }
+        if (request.core != 0)
+        {
+            fprintf(stderr, "Streamed traces run on a single core, line %zu: %.*s\n", lineNumber,
+                    (int)(end - line), line);
+            exit(1);
+        }
+
+        unsigned spins = 0;
+        while (head - tail == TRACE_STREAM_CAPACITY &&
+               head - (tail = atomic_load_explicit(&stream->tail, memory_order_acquire)) == TRACE_STREAM_CAPACITY)
+        {
+            if (atomic_load_explicit(&stream->closed, memory_order_relaxed))
+            {
+                break;
+            }
+            backOff(&spins);
+        }
+        if (head - tail == TRACE_STREAM_CAPACITY) // Closed while the ring was full
+        {
+            break;
+        }
+        stream->ring[head & RING_MASK] = request;
+        atomic_store_explicit(&stream->head, ++head, memory_order_release);
+    }
+
+    if (ferror(stream->file))
+    {
+        fprintf(stderr, "Error reading the trace after line %zu\n", lineNumber);
+        exit(1);
+    }
+    free(line);
+    atomic_store_explicit(&stream->finished, 1, memory_order_release);
+    return NULL;
+}
+
+/*
+    Opens a trace and starts the reader thread
+    parameters:
+        path: path to the csv file, "-" for standard input
+    returns: the stream (exits with an error message if the file cannot be opened)
+*/
+TraceStream* openTraceStream(const char* path)
+{
+    TraceStream* stream = aligned_alloc(_Alignof(TraceStream), sizeof(TraceStream));
+    if (!stream)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    stream->file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!stream->file)
+    {
+        fprintf(stderr, "Error opening file: %s\n", path);
+        exit(1);
+    }
+    atomic_init(&stream->head, 0);
+    atomic_init(&stream->tail, 0);
+    atomic_init(&stream->finished, 0);
+    atomic_init(&stream->closed, 0);
+    stream->consumed = 0;
+    if (pthread_create(&stream->reader, NULL, readTrace, stream) != 0)
+    {
+        fprintf(stderr, "Failed to start the trace reader\n");
+        exit(1);
+    }
+    return stream;
+}
+
+/*
+    Takes the next requests out of the stream, waiting for the reader if the ring is empty, a RequestSource
+    parameters:
+        stream: the stream
+        requests: buffer receiving the requests
+        max: size of the buffer
+    returns: number of requests stored, 0 at the end of the trace (the reader exits with an error message on a
+             malformed line)
+*/
+size_t readTraceStream(void* stream, struct Request* requests, size_t max)
+{
+    TraceStream* traceStream = stream;
+    const size_t tail = atomic_load_explicit(&traceStream->tail, memory_order_relaxed);
+    size_t head;
+    unsigned spins = 0;
+    while ((head = atomic_load_explicit(&traceStream->head, memory_order_acquire)) == tail)
+    {
+        // The last request is published before finished, so a second look at head settles the end of the trace
+        if (atomic_load_explicit(&traceStream->finished, memory_order_acquire))
+        {
+            head = atomic_load_explicit(&traceStream->head, memory_order_acquire);
+            if (head == tail)
+            {
+                return 0;
+            }
+            break;
+        }
+        backOff(&spins);
+    }
+
+    size_t count = head - tail < max ? head - tail : max;
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i] = traceStream->ring[(tail + i) & RING_MASK];
+    }
+    atomic_store_explicit(&traceStream->tail, tail + count, memory_order_release);
+    traceStream->consumed += count;
+    return count;
+}
+
+/*
+    Stops the reader thread, also if the trace was not read to its end, and closes the stream
+    parameters:
+        stream: the stream
+    returns: number of requests taken out of the stream
+*/
+size_t closeTraceStream(TraceStream* stream)
+{
+    atomic_store_explicit(&stream->closed, 1, memory_order_relaxed);
+    pthread_join(stream->reader, NULL);
+    if (stream->file != stdin)
+    {
+        fclose(stream->file);
+    }
+    const size_t consumed = stream->consumed;
+    free(stream);
+    return consumed;
+}
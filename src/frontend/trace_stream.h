@@ -0,0 +1,48 @@
+#ifndef TRACE_STREAM_H
+#define TRACE_STREAM_H
+
+#include <stddef.h>
+
+#include "simulation.h"
+
+/*
+    Streamed CSV traces.
+
+    A reader thread parses the trace line by line into a ring buffer of TRACE_STREAM_CAPACITY requests, the
+    simulation takes them out in batches through readTraceStream. The reader is the only thread writing the head of
+    the ring and the simulation the only one writing its tail, so neither takes a lock, and memory use stays the same
+    however long the trace is. The trace may be a pipe, "-" reads standard input.
+*/
+
+#define TRACE_STREAM_CAPACITY 65536 // Requests in the ring, a power of two
+
+typedef struct TraceStream TraceStream;
+
+/*
+    Opens a trace and starts the reader thread
+    parameters:
+        path: path to the csv file, "-" for standard input
+    returns: the stream (exits with an error message if the file cannot be opened)
+*/
+TraceStream* openTraceStream(const char* path);
+
+/*
+    Takes the next requests out of the stream, waiting for the reader if the ring is empty, a RequestSource
+    parameters:
+        stream: the stream
+        requests: buffer receiving the requests
+        max: size of the buffer
+    returns: number of requests stored, 0 at the end of the trace (the reader exits with an error message on a
+             malformed line)
+*/
+size_t readTraceStream(void* stream, struct Request* requests, size_t max);
+
+/*
+    Stops the reader thread, also if the trace was not read to its end, and closes the stream
+    parameters:
+        stream: the stream
+    returns: number of requests taken out of the stream
+*/
+size_t closeTraceStream(TraceStream* stream);
+
+#endif // TRACE_STREAM_H
@@ -0,0 +1,363 @@
+#ifndef CACHEENGINE_H
+#define CACHEENGINE_H
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "cacheStorage.h"
+#include "replacementPolicy.h"
+
+/**
+ * Contents of a block on its way between two cache levels
+ */
+struct CacheBlock
+{
+    bool valid = false; ///< Whether the structure holds a block
+    bool dirty = false; ///< Whether the block was written since it came from memory
+    uint32_t addr = 0; ///< Base address of the block
+    std::vector<uint64_t> mask; ///< Valid bits of the words
+    std::vector<uint32_t> data; ///< Words of the block, only the valid ones are meaningful
+
+    bool word_valid(const uint32_t offset) const { return (mask[offset / 64] >> (offset % 64)) & 1; }
+};
+
+/**
+ * Functional model of an N-way set-associative cache.
+ * Direct mapped is the 1-way and fully associative the CACHE_LINES-way special case.
+ * The engine holds no notion of time, the timing is added by the module driving it.
+ * @tparam Policy replacement policy, see replacementPolicy.h
+ */
+template <class Policy>
+class CacheEngine
+{
+public:
+    const unsigned CACHE_LINES; ///< Number of Cache Lines
+    const unsigned CACHE_LINE_SIZE; ///< Size of a Cache Line
+    const unsigned WAYS; ///< Number of Cache Lines per Set
+    const unsigned SETS; ///< Number of Sets
+    const unsigned OFFSET_BITS = log2(CACHE_LINE_SIZE); ///< Number of bits for the offset
+    const unsigned INDEX_BITS = log2(SETS); ///< Number of bits for the set index
+    const unsigned TAG_BITS = 32 - OFFSET_BITS - INDEX_BITS; ///< Number of bits for the tag
+    const bool CLEAN_DATA; ///< Whether clean blocks leaving the cache are copied out with their words
+
+    /**
+     * Constructor of the Engine
+     * @param cacheLines
+     * @param cacheLineSize
+     * @param ways
+     * @param cleanData copy the words of clean blocks leaving the cache, only needed if they move to another level
+     */
+    CacheEngine(const unsigned cacheLines, const unsigned cacheLineSize, const unsigned ways,
+                const bool cleanData = true) :
+        CACHE_LINES(cacheLines),
+        CACHE_LINE_SIZE(cacheLineSize),
+        WAYS(ways),
+        SETS(cacheLines / ways),
+        CLEAN_DATA(cleanData),
+        storage(cacheLines, cacheLineSize),
+        policy(SETS, WAYS)
+    {
+        // Every way starts out free, way 0 is filled first
+        free_ways.resize(CACHE_LINES);
+        free_count.assign(SETS, WAYS);
+        for (unsigned line = 0; line < CACHE_LINES; ++line)
+        {
+            free_ways[line] = WAYS - 1 - line % WAYS;
+        }
+
+        if (WAYS > SCAN_WAYS)
+        {
+            block_index.reserve(CACHE_LINES);
+        }
+    }
+
+    /**
+     * Look up a request address and report a hit to the replacement policy
+     * @param addr
+     * @param data receives the cached data on a hit
+     * @return true on a hit
+     */
+    bool lookup(const uint32_t addr, uint32_t& data)
+    {
+        const int line = find_line(addr);
+        if (line == -1 || !storage.is_valid(line, offset_of(addr)))
+        {
+            return false;
+        }
+        touch(line);
+        data = storage.read(line, offset_of(addr));
+        return true;
+    }
+
+    /**
+     * Read a cached word without counting it as a reference, for snooping
+     * @param addr
+     * @param data receives the cached data if the word is valid
+     * @return true if the word is valid
+     */
+    bool peek(const uint32_t addr, uint32_t& data) const
+    {
+        const int line = find_line(addr);
+        if (line == -1 || !storage.is_valid(line, offset_of(addr)))
+        {
+            return false;
+        }
+        data = storage.read(line, offset_of(addr));
+        return true;
+    }
+
+    /**
+     * Store data for a request address, allocating a line chosen by the replacement policy if the block is absent.
+     * A block that is present but misses the word counts as referenced, a word that hit in lookup is not counted twice.
+     * @param addr
+     * @param data
+     * @param victim receives the evicted block if not null (victim->valid tells whether there was one)
+     * @param dirty mark the line as modified (write back)
+     */
+    void update(const uint32_t addr, const uint32_t data, CacheBlock* victim = nullptr, const bool dirty = false)
+    {
+        int line = find_line(addr);
+        if (victim)
+        {
+            victim->valid = false;
+        }
+        if (line == -1)
+        {
+            line = allocate(addr, victim);
+        }
+        else if (!storage.is_valid(line, offset_of(addr)))
+        {
+            touch(line);
+        }
+        storage.write(line, offset_of(addr), data); ///< Write the data to the cache and set the valid bit
+        if (dirty)
+        {
+            storage.set_dirty(line);
+        }
+    }
+
+    /**
+     * @param addr
+     * @return true if the block of the address is cached, no matter which of its words are valid
+     */
+    bool contains(const uint32_t addr) const
+    {
+        return find_line(addr) != -1;
+    }
+
+    /**
+     * Remove the block of an address from the cache
+     * @param addr
+     * @param block receives the block's contents if not null
+     * @return true if the block was cached
+     */
+    bool invalidate(const uint32_t addr, CacheBlock* block = nullptr)
+    {
+        const int line = find_line(addr);
+        if (line == -1)
+        {
+            return false;
+        }
+        if (block)
+        {
+            save(line, *block);
+        }
+        const uint32_t set = set_of(addr);
+        if (WAYS > SCAN_WAYS)
+        {
+            block_index.erase(addr >> OFFSET_BITS);
+        }
+        storage.invalidate(line);
+        policy.on_invalidate(set, line % WAYS);
+        free_ways[set * WAYS + free_count[set]++] = line % WAYS;
+        return true;
+    }
+
+    /**
+     * Place a whole block, merging its valid words into the line if the block is already cached
+     * @param block
+     * @param victim receives the evicted block if not null
+     */
+    void install(const CacheBlock& block, CacheBlock* victim = nullptr)
+    {
+        int line = find_line(block.addr);
+        if (victim)
+        {
+            victim->valid = false;
+        }
+        if (line == -1)
+        {
+            line = allocate(block.addr, victim);
+        }
+        else
+        {
+            touch(line);
+        }
+        if (block.dirty)
+        {
+            storage.set_dirty(line);
+        }
+        for (uint32_t offset = 0; offset < CACHE_LINE_SIZE; ++offset)
+        {
+            if (block.word_valid(offset))
+            {
+                storage.write(line, offset, block.data[offset]);
+            }
+        }
+    }
+
+    /**
+     * Copy the block of an address with all of its valid words, without counting it as a reference
+     * @param addr
+     * @param block receives the block's contents
+     * @return true if the block is cached
+     */
+    bool copy_block(const uint32_t addr, CacheBlock& block) const
+    {
+        const int line = find_line(addr);
+        if (line == -1)
+        {
+            return false;
+        }
+        block.valid = true;
+        block.dirty = storage.is_dirty(line);
+        block.addr = addr & ~(CACHE_LINE_SIZE - 1);
+        storage.copy_out(line, block.mask, block.data);
+        return true;
+    }
+
+    /**
+     * Fill the words cached blocks are missing from a block of another level, without counting a reference. Words
+     * the cache already holds are kept, words of blocks it does not hold are skipped.
+     * @param block block of the level below, of any line size
+     */
+    void fill_missing(const CacheBlock& block)
+    {
+        for (uint32_t offset = 0; offset < block.data.size(); ++offset)
+        {
+            const uint32_t addr = block.addr + offset;
+            const int line = block.word_valid(offset) ? find_line(addr) : -1;
+            if (line != -1 && !storage.is_valid(line, offset_of(addr)))
+            {
+                storage.write(line, offset_of(addr), block.data[offset]);
+            }
+        }
+    }
+
+    /**
+     * @return number of blocks replaced to make room for another block
+     */
+    size_t evictions() const { return evicted; }
+
+private:
+    static constexpr unsigned SCAN_WAYS = 8; ///< Up to this associativity the ways of a set are scanned linearly
+
+    CacheStorage storage; ///< Tags, valid bits and data of the Cache Lines, set by set
+    std::unordered_map<uint32_t, unsigned> block_index; ///< Block address -> line, only used above SCAN_WAYS ways
+    std::vector<unsigned> free_ways; ///< Stack of the ways holding no block, WAYS entries per set
+    std::vector<unsigned> free_count; ///< Height of each set's free stack
+    Policy policy; ///< Replacement state
+    size_t evicted = 0; ///< Blocks replaced by allocate
+
+    uint32_t offset_of(const uint32_t addr) const
+    {
+        return addr & ((1u << OFFSET_BITS) - 1);
+    }
+
+    uint32_t set_of(const uint32_t addr) const
+    {
+        return (addr >> OFFSET_BITS) & ((1u << INDEX_BITS) - 1);
+    }
+
+    uint32_t tag_of(const uint32_t addr) const
+    {
+        return static_cast<uint32_t>(static_cast<uint64_t>(addr) >> (OFFSET_BITS + INDEX_BITS));
+    }
+
+    /**
+     * Find the line holding the block of an address
+     * @param addr
+     * @return line index or -1 if the block is not cached
+     */
+    int find_line(const uint32_t addr) const
+    {
+        if (WAYS > SCAN_WAYS)
+        {
+            const auto it = block_index.find(addr >> OFFSET_BITS);
+            return it != block_index.end() ? static_cast<int>(it->second) : -1;
+        }
+        const unsigned first = set_of(addr) * WAYS;
+        const uint32_t tag = tag_of(addr);
+        for (unsigned line = first; line < first + WAYS; ++line)
+        {
+            if (storage.is_present(line) && storage.tag(line) == tag)
+            {
+                return static_cast<int>(line);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Assign a line of the address' set to the address' block, preferring free ways over evicting the policy's victim
+     * @param addr
+     * @param victim receives the evicted block if not null
+     * @return line index
+     */
+    unsigned allocate(const uint32_t addr, CacheBlock* victim)
+    {
+        const uint32_t set = set_of(addr);
+        const unsigned way = free_count[set] > 0
+                                 ? free_ways[set * WAYS + --free_count[set]]
+                                 : policy.victim(set);
+        const unsigned line = set * WAYS + way;
+        if (storage.is_present(line))
+        {
+            evicted++;
+            if (victim)
+            {
+                save(line, *victim);
+            }
+            if (WAYS > SCAN_WAYS)
+            {
+                block_index.erase(storage.tag(line) << INDEX_BITS | set);
+            }
+        }
+        storage.assign(line, tag_of(addr)); ///< The old block's data is no longer valid
+        if (WAYS > SCAN_WAYS)
+        {
+            block_index[addr >> OFFSET_BITS] = line;
+        }
+        policy.on_fill(set, way);
+        return line;
+    }
+
+    /**
+     * Copy a line into a block, a clean block only carries its words if CLEAN_DATA is set
+     * @param line
+     * @param block
+     */
+    void save(const unsigned line, CacheBlock& block) const
+    {
+        block.valid = true;
+        block.dirty = storage.is_dirty(line);
+        block.addr = (storage.tag(line) << INDEX_BITS | line / WAYS) << OFFSET_BITS;
+        if (block.dirty || CLEAN_DATA)
+        {
+            storage.copy_out(line, block.mask, block.data);
+        }
+    }
+
+    /**
+     * Report a reference to a line to the replacement policy
+     * @param line
+     */
+    void touch(const unsigned line)
+    {
+        policy.on_hit(line / WAYS, line % WAYS);
+    }
+};
+
+#endif //CACHEENGINE_H
@@ -0,0 +1,854 @@
+#ifndef CACHEHIERARCHY_H
+#define CACHEHIERARCHY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cacheEngine.h"
+#include "dramModel.h"
+#include "prefetcher.h"
+#include "simulation.h"
+
+/**
+ * Outcome of one access to the cache hierarchy
+ */
+struct HierarchyAccess
+{
+    int level; ///< Level that held the requested word (0 = L1), -1 if it has to come from memory
+    size_t cycles; ///< Cycles the access added to the run, including the memory latency (all of it when blocking)
+};
+
+/**
+ * Word the hierarchy hands to memory, either written through or written back
+ */
+struct MemoryWrite
+{
+    uint32_t addr; ///< Address of the word
+    uint32_t data; ///< Data of the word
+};
+
+constexpr uint64_t NO_BLOCK = UINT64_MAX; ///< Empty entry of a table of block addresses
+
+/**
+ * Functional and timing model of a chain of cache levels in front of the memory, all using the same replacement
+ * policy. Every access walks the levels from L1 down until one holds the word, paying each level's latency on the
+ * way, and then places the word according to the inclusion policy.
+ * Writes are either written through to memory or kept as dirty blocks that are written back when they leave the
+ * hierarchy. The words destined for memory are queued and have to be drained by the caller after every access.
+ * Memory accesses cost the flat memory latency, or whatever the DRAM model says at the time they are issued.
+ * A blocking hierarchy starts a request at the cycle the previous one finished. A non-blocking one issues a request
+ * per cycle as long as fewer than ISSUE_WINDOW are in flight: hits are served under outstanding misses, a read miss
+ * takes one of the MSHRs of L1 until its block arrives and reads of a block that is already on its way wait for it
+ * instead of going to memory again. The contents are still updated in request order, only the timing overlaps.
+ * Every access reports how far it moved the finish of the whole run, so the cycles of all accesses add up to it.
+ * An optional prefetcher watches the demand accesses to L1. The blocks it asks for are fetched from memory in the
+ * background when the access that triggered them missed, a demand access to such a block waits only for the rest of
+ * the fetch. Like the memory writes, the words to prefetch have to be read from memory by the caller.
+ * An optional victim cache behind L1 catches the blocks L1 evicts. It is looked up after an L1 miss at its own latency
+ * and a block found there is swapped back into L1, so the access counts as served by L1 even though L1 missed.
+ * @tparam Policy replacement policy, see replacementPolicy.h
+ */
+template <class Policy>
+class CacheHierarchy
+{
+public:
+    const unsigned NUM_LEVELS; ///< Number of cache levels
+    const unsigned MEMORY_LATENCY; ///< Latency of the Memory in Cycles
+    const InclusionPolicy INCLUSION; ///< Inclusion policy between the levels
+    const WritePolicy WRITE_POLICY; ///< Write-through or write-back
+    const bool WRITE_ALLOCATE; ///< Whether a write miss allocates a block
+    const unsigned MSHRS; ///< Miss status holding registers of L1, 0 for a blocking hierarchy
+    const unsigned ISSUE_WINDOW; ///< Requests in flight at once when non-blocking
+    const unsigned VICTIM_LATENCY; ///< Latency of the victim cache in Cycles, 0 without one
+    const bool LOG_EVICTIONS; ///< Whether the block L1 evicts for a request is kept for the event log
+
+    /**
+     * Constructor of the Hierarchy
+     * @param config levels, memory latency, inclusion and write policy
+     */
+    explicit CacheHierarchy(const SimulationConfig& config) :
+        NUM_LEVELS(config.numLevels),
+        MEMORY_LATENCY(config.memoryLatency),
+        INCLUSION(static_cast<InclusionPolicy>(config.inclusion)),
+        WRITE_POLICY(static_cast<WritePolicy>(config.writePolicy)),
+        WRITE_ALLOCATE(config.writeAllocate != 0),
+        MSHRS(config.mshrs),
+        ISSUE_WINDOW(config.mshrs != 0 ? std::max(config.issueWindow, 1u) : 1),
+        VICTIM_LATENCY(config.victimEntries != 0 ? config.victimLatency : 0),
+        LOG_EVICTIONS(config.eventLog != nullptr),
+        stats(config.numLevels, LevelStats{}),
+        dram(config.dram.channels != 0 ? new DramModel(config.dram) : nullptr),
+        mshrs(config.mshrs, Mshr{0, 0}),
+        completions(ISSUE_WINDOW, 0),
+        prefetcher(create_prefetcher(config)),
+        polluters(prefetcher ? config.levels[0].cacheLines : 0, NO_BLOCK)
+    {
+        if (config.victimEntries != 0) ///< Fully associative with LRU replacement, whatever the levels use
+        {
+            victim_cache.reset(new CacheEngine<LruPolicy>(config.victimEntries, config.levels[0].cacheLineSize,
+                                                          config.victimEntries));
+        }
+        for (unsigned i = 0; i < NUM_LEVELS; ++i)
+        {
+            const CacheLevelConfig& level = config.levels[i];
+            const bool moves_clean = INCLUSION == INCLUSION_EXCLUSIVE || (i == 0 && victim_cache);
+            levels.emplace_back(new CacheEngine<Policy>(level.cacheLines, level.cacheLineSize, level.ways,
+                                                        moves_clean));
+            latencies.push_back(level.latency);
+        }
+    }
+
+    /**
+     * Read a word
+     * @param addr
+     * @param data receives the word if a level held it
+     * @return level that held the word (-1: call fill with the word from memory) and cycles
+     */
+    HierarchyAccess read(const uint32_t addr, uint32_t& data)
+    {
+        begin_request();
+        HierarchyAccess access = find(addr, data);
+        elapsed = access.cycles;
+        train_prefetcher(addr, access.level, true);
+        const Mshr* pending = MSHRS != 0 ? outstanding(addr) : nullptr;
+        merged = pending != nullptr;
+        if (pending) ///< Secondary miss, the word arrives with the block
+        {
+            mshr_merges++;
+            elapsed = std::max(elapsed, pending->ready - clock);
+        }
+        else if (MSHRS != 0 && access.level != 0)
+        {
+            allocate_mshr(addr, access.level < 0);
+        }
+        else if (access.level < 0)
+        {
+            elapsed += memory_cycles(addr);
+        }
+        if (access.level > 0)
+        {
+            promote(addr, data, static_cast<unsigned>(access.level));
+        }
+        access.cycles = retire();
+        return access;
+    }
+
+    /**
+     * Place a word read from memory after a read missed in every level. The word of a read merged into an outstanding
+     * miss arrives with the block of that miss, so it is not counted as another memory read.
+     * @param addr
+     * @param data
+     * @return cycles the write-backs of the dirty blocks the fill evicted added to the run
+     */
+    size_t fill(const uint32_t addr, const uint32_t data)
+    {
+        if (!merged)
+        {
+            memory_reads++;
+        }
+        place(addr, data, NUM_LEVELS, false);
+        return retire();
+    }
+
+    /**
+     * Write a word, through to memory or into the cache as a dirty word
+     * @param addr
+     * @param data
+     * @return level that held the word before the write (-1 if none) and cycles
+     */
+    HierarchyAccess write(const uint32_t addr, const uint32_t data)
+    {
+        begin_request();
+        uint32_t old_data = 0;
+        HierarchyAccess access = find(addr, old_data);
+        elapsed = access.cycles;
+        train_prefetcher(addr, access.level, false); ///< Nothing waits for the block of a write
+
+        if (WRITE_POLICY == WRITE_THROUGH)
+        {
+            // The write passes every level on its way to memory
+            elapsed = 0;
+            for (const unsigned latency : latencies)
+            {
+                elapsed += latency;
+            }
+
+            if (WRITE_ALLOCATE)
+            {
+                place(addr, data, NUM_LEVELS, false); ///< Keep every copy of the block up to date
+            }
+            else
+            {
+                for (unsigned i = 0; i < NUM_LEVELS; ++i) ///< Only update the copies that exist
+                {
+                    if (levels[i]->contains(addr))
+                    {
+                        levels[i]->update(addr, data);
+                    }
+                }
+            }
+            elapsed += memory_cycles(addr);
+            write_to_memory(addr, data);
+        }
+        else if (access.level == 0)
+        {
+            levels[0]->update(addr, data, nullptr, true);
+        }
+        else if (WRITE_ALLOCATE)
+        {
+            // Every word is valid on its own, so the block is allocated without fetching the rest of it
+            place(addr, data, NUM_LEVELS, true);
+        }
+        else if (!write_into_block(addr, data, 0)) ///< The write goes around the cache
+        {
+            elapsed += memory_cycles(addr);
+            write_to_memory(addr, data);
+        }
+        access.cycles = retire();
+        return access;
+    }
+
+    /**
+     * Start fetching the blocks the prefetcher asked for since the last call that are neither cached nor on their way
+     * already. Call it after the access and its fill, with the memory writes drained.
+     * @return words the caller has to read from memory and hand to prefetch_fill
+     */
+    const std::vector<uint32_t>& issue_prefetches()
+    {
+        prefetch_words.clear();
+        for (const uint32_t block : prefetch_targets)
+        {
+            if (prefetched.count(block) || cached(block))
+            {
+                continue;
+            }
+            size_t ready = prefetch_issue + MEMORY_LATENCY;
+            if (dram) ///< The words are issued together and compete with the demand accesses for the DRAM
+            {
+                ready = prefetch_issue;
+                for (uint32_t offset = 0; offset < levels[0]->CACHE_LINE_SIZE; ++offset)
+                {
+                    ready = std::max(ready, dram->access(block + offset, prefetch_issue));
+                }
+            }
+            for (uint32_t offset = 0; offset < levels[0]->CACHE_LINE_SIZE; ++offset)
+            {
+                prefetch_words.push_back(block + offset);
+            }
+            prefetched[block] = ready;
+            prefetch_issued++;
+        }
+        prefetch_targets.clear();
+
+        // Forget the prefetched blocks that left L1 unused once there are more than L1 can hold
+        if (prefetched.size() > 2 * static_cast<size_t>(levels[0]->CACHE_LINES))
+        {
+            for (auto it = prefetched.begin(); it != prefetched.end();)
+            {
+                it = levels[0]->contains(it->first) ? std::next(it) : prefetched.erase(it);
+            }
+        }
+        return prefetch_words;
+    }
+
+    /**
+     * Place a prefetched word read from memory, without adding to the time of the current request
+     * @param addr
+     * @param data
+     */
+    void prefetch_fill(const uint32_t addr, const uint32_t data)
+    {
+        const size_t before = elapsed;
+        prefetching = true;
+        memory_reads++;
+        place(addr, data, NUM_LEVELS, false);
+        prefetching = false;
+        elapsed = before;
+    }
+
+    /**
+     * Words queued for memory since the last drain, oldest first
+     * @return queued writes
+     */
+    const std::vector<MemoryWrite>& pending_writes() const { return memory_writes; }
+
+    /**
+     * Forget the queued memory writes once the caller has performed them
+     */
+    void clear_pending_writes() { memory_writes.clear(); }
+
+    /**
+     * Block L1 evicted for the last demand request, kept only when the config has an event log
+     * @return base address of the block, NO_BLOCK if L1 evicted none
+     */
+    uint64_t l1_eviction() const { return l1_evicted; }
+
+    /**
+     * Write the per-level statistics, the AMAT and the memory traffic into a result
+     * @param result
+     */
+    void report(Result& result) const
+    {
+        result.numLevels = NUM_LEVELS;
+        double amat = MEMORY_LATENCY; ///< AMAT below the last level, the average DRAM latency if it was used
+        if (dram && dram->statistics().accesses)
+        {
+            amat = static_cast<double>(dram->statistics().latencyCycles) / dram->statistics().accesses;
+        }
+        for (unsigned i = NUM_LEVELS; i-- > 0;)
+        {
+            result.levels[i] = stats[i];
+            result.levels[i].evictions = levels[i]->evictions();
+            if (i == 0 && victim_cache) ///< L1 misses go through the victim cache first
+            {
+                const size_t lookups = victim_hits + victim_misses;
+                amat = VICTIM_LATENCY + (lookups ? static_cast<double>(victim_misses) / lookups : 0.0) * amat;
+            }
+            const size_t lookups = stats[i].hits + stats[i].misses;
+            const double miss_rate = lookups ? static_cast<double>(stats[i].misses) / lookups : 0.0;
+            amat = latencies[i] + miss_rate * amat;
+            result.levels[i].amat = amat;
+        }
+        result.amat = amat;
+        result.memoryReads = memory_reads;
+        result.memoryWrites = memory_word_writes;
+        result.writebacks = writebacks;
+        if (dram)
+        {
+            result.dram = dram->statistics();
+        }
+        result.mshrMerges = mshr_merges;
+        result.mshrStallCycles = mshr_stall_cycles;
+        result.prefetchIssued = prefetch_issued;
+        result.prefetchUseful = prefetch_useful;
+        result.prefetchLate = prefetch_late;
+        result.prefetchPolluting = prefetch_polluting;
+        result.victimHits = victim_hits;
+        result.victimMisses = victim_misses;
+        result.victimSwaps = victim_swaps;
+    }
+
+private:
+    /**
+     * Miss status holding register, tracks the block of an outstanding L1 miss
+     */
+    struct Mshr
+    {
+        uint32_t block; ///< Base address of the missing L1 block
+        size_t ready; ///< Cycle the block arrives, the register is free from then on
+    };
+
+    std::vector<std::unique_ptr<CacheEngine<Policy>>> levels; ///< Cache levels, L1 first
+    std::vector<unsigned> latencies; ///< Latency of each level
+    std::vector<LevelStats> stats; ///< Statistics of each level
+    CacheBlock victim; ///< Block evicted by the level currently being filled
+    CacheBlock moved; ///< Block moved between levels
+    CacheBlock dropped; ///< Block dropped by a back-invalidation
+    CacheBlock spilled; ///< Block evicted from the victim cache
+    std::vector<MemoryWrite> memory_writes; ///< Words waiting to be written to memory
+    std::unique_ptr<DramModel> dram; ///< DRAM timing model, null for the flat memory latency
+    std::vector<Mshr> mshrs; ///< MSHRs of L1
+    std::vector<size_t> completions; ///< Completion cycle of the last ISSUE_WINDOW requests, by request number
+    size_t issued = 0; ///< Requests issued so far
+    size_t clock = 0; ///< Cycle the current request started
+    size_t elapsed = 0; ///< Cycles the current request has taken so far
+    size_t finish = 0; ///< Cycle the last request in flight finishes
+    size_t mshr_merges = 0; ///< Reads merged into an outstanding miss
+    bool merged = false; ///< Whether the last read merged into an outstanding miss
+    size_t mshr_stall_cycles = 0; ///< Cycles misses waited for a free MSHR
+    std::unique_ptr<Prefetcher> prefetcher; ///< Prefetcher of L1, null if prefetching is off
+    std::vector<uint32_t> prefetch_targets; ///< Blocks the prefetcher asked for during the current request
+    std::vector<uint32_t> prefetch_words; ///< Words of the blocks being prefetched, for the caller to read
+    std::unordered_map<uint32_t, size_t> prefetched; ///< Prefetched blocks not used yet -> cycle they arrive
+    std::vector<uint64_t> polluters; ///< Blocks recently evicted from L1 by a prefetch, indexed by block
+    size_t prefetch_issue = 0; ///< Cycle the prefetches of the current request are issued
+    bool prefetching = false; ///< Whether the word being placed was prefetched
+    size_t prefetch_issued = 0; ///< Blocks prefetched
+    size_t prefetch_useful = 0; ///< Prefetched blocks used by a demand access
+    size_t prefetch_late = 0; ///< Used prefetched blocks that had not arrived yet
+    size_t prefetch_polluting = 0; ///< Demand misses on blocks a prefetch evicted
+    std::unique_ptr<CacheEngine<LruPolicy>> victim_cache; ///< Victim cache behind L1, null if there is none
+    size_t victim_hits = 0; ///< L1 misses the victim cache held the word for
+    size_t victim_misses = 0; ///< L1 misses the victim cache did not hold the word for
+    size_t victim_swaps = 0; ///< Blocks moved from the victim cache back into L1
+    size_t memory_reads = 0; ///< Words read from memory
+    size_t memory_word_writes = 0; ///< Words written to memory
+    size_t writebacks = 0; ///< Dirty blocks written back to memory
+    uint64_t l1_evicted = NO_BLOCK; ///< Block L1 evicted for the current demand request
+
+    /**
+     * Start the timing of a new request, right after the previous one when blocking, otherwise one cycle after the
+     * previous one was issued and once the request ISSUE_WINDOW requests back has finished
+     */
+    void begin_request()
+    {
+        if (MSHRS == 0)
+        {
+            clock += elapsed;
+        }
+        else if (issued++ != 0)
+        {
+            completions[(issued - 2) % ISSUE_WINDOW] = clock + elapsed;
+            clock = std::max(clock + 1, completions[(issued - 1) % ISSUE_WINDOW]);
+        }
+        elapsed = 0;
+        l1_evicted = NO_BLOCK;
+    }
+
+    /**
+     * Account for the cycles the current request took so far
+     * @return cycles the request moved the finish of the run since the last call
+     */
+    size_t retire()
+    {
+        const size_t before = finish;
+        finish = std::max(finish, clock + elapsed);
+        return finish - before;
+    }
+
+    /**
+     * Account a demand access to the prefetches and let the prefetcher observe it
+     * @param addr
+     * @param level level that held the word
+     * @param wait whether the access waits for a prefetched block that has not arrived yet
+     */
+    void train_prefetcher(const uint32_t addr, const int level, const bool wait)
+    {
+        if (!prefetcher)
+        {
+            return;
+        }
+        const uint32_t block = addr & ~(levels[0]->CACHE_LINE_SIZE - 1);
+        bool trigger = level != 0;
+        const auto it = prefetched.find(block);
+        if (it != prefetched.end())
+        {
+            if (levels[0]->contains(block)) ///< First use of the prefetched block
+            {
+                prefetch_useful++;
+                if (it->second > clock + elapsed)
+                {
+                    prefetch_late++;
+                    if (wait)
+                    {
+                        elapsed = it->second - clock;
+                    }
+                }
+                trigger = true;
+            }
+            prefetched.erase(it);
+        }
+        if (level != 0)
+        {
+            uint64_t& polluter = polluters[block / levels[0]->CACHE_LINE_SIZE % polluters.size()];
+            if (polluter == block)
+            {
+                prefetch_polluting++;
+                polluter = NO_BLOCK;
+            }
+        }
+        prefetch_issue = clock + latencies[0];
+        prefetcher->observe(addr, trigger, prefetch_targets);
+    }
+
+    /**
+     * Whether any level holds part of an L1 block
+     * @param block base address of the L1 block
+     * @return true if a level holds a block overlapping it
+     */
+    bool cached(const uint32_t block) const
+    {
+        for (unsigned i = 0; i < NUM_LEVELS; ++i)
+        {
+            const uint32_t step = std::min(levels[i]->CACHE_LINE_SIZE, levels[0]->CACHE_LINE_SIZE);
+            for (uint32_t offset = 0; offset < levels[0]->CACHE_LINE_SIZE; offset += step)
+            {
+                if (levels[i]->contains(block + offset))
+                {
+                    return true;
+                }
+            }
+        }
+        return victim_cache && victim_cache->contains(block);
+    }
+
+    /**
+     * Remember a block a prefetch evicted from L1, so a later demand miss on it counts as pollution
+     * @param block base address of the evicted block
+     */
+    void record_polluter(const uint32_t block)
+    {
+        polluters[block / levels[0]->CACHE_LINE_SIZE % polluters.size()] = block;
+    }
+
+    /**
+     * MSHR holding the L1 block of an address that is still on its way
+     * @param addr
+     * @return register or null if the block is not outstanding
+     */
+    const Mshr* outstanding(const uint32_t addr) const
+    {
+        const uint32_t block = addr & ~(levels[0]->CACHE_LINE_SIZE - 1);
+        for (const Mshr& mshr : mshrs)
+        {
+            if (mshr.ready > clock && mshr.block == block)
+            {
+                return &mshr;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Take the MSHR that frees up first for an L1 miss, waiting for it if all of them are busy, and track the miss
+     * until the block arrives
+     * @param addr
+     * @param memory whether the block comes from memory, otherwise a lower level already counted in elapsed has it
+     */
+    void allocate_mshr(const uint32_t addr, const bool memory)
+    {
+        Mshr& mshr = *std::min_element(mshrs.begin(), mshrs.end(), [](const Mshr& a, const Mshr& b)
+        {
+            return a.ready < b.ready;
+        });
+        const size_t detected = clock + latencies[0] + VICTIM_LATENCY; ///< The miss is known after the L1 lookup
+        if (mshr.ready > detected)
+        {
+            mshr_stall_cycles += mshr.ready - detected;
+            elapsed += mshr.ready - detected;
+        }
+        if (memory)
+        {
+            elapsed += memory_cycles(addr);
+        }
+        mshr.block = addr & ~(levels[0]->CACHE_LINE_SIZE - 1);
+        mshr.ready = clock + elapsed;
+    }
+
+    /**
+     * Cycles a word access to memory issued now takes
+     * @param addr
+     * @return flat memory latency or the DRAM's latency including queueing
+     */
+    size_t memory_cycles(const uint32_t addr)
+    {
+        if (!dram)
+        {
+            return MEMORY_LATENCY;
+        }
+        const size_t issue = clock + elapsed;
+        return dram->access(addr, issue) - issue;
+    }
+
+    /**
+     * Whether the victims of a level have to be looked at
+     * @param level
+     * @return true if victims can be dirty, have to be back-invalidated or go to the victim cache
+     */
+    bool tracks_victims(const unsigned level) const
+    {
+        if (level == 0 && victim_cache)
+        {
+            return true;
+        }
+        if (INCLUSION == INCLUSION_EXCLUSIVE)
+        {
+            return NUM_LEVELS > 1 || WRITE_POLICY == WRITE_BACK;
+        }
+        return WRITE_POLICY == WRITE_BACK || (INCLUSION == INCLUSION_INCLUSIVE && level > 0);
+    }
+
+    /**
+     * Walk the levels until one holds the word
+     * @param addr
+     * @param data receives the word if a level held it
+     * @return level and the cycles of the levels walked
+     */
+    HierarchyAccess find(const uint32_t addr, uint32_t& data)
+    {
+        HierarchyAccess access{-1, 0};
+        for (unsigned i = 0; i < NUM_LEVELS; ++i)
+        {
+            access.cycles += latencies[i];
+            if (levels[i]->lookup(addr, data))
+            {
+                stats[i].hits++;
+                access.level = static_cast<int>(i);
+                return access;
+            }
+            stats[i].misses++;
+            if (i == 0 && victim_cache)
+            {
+                access.cycles += VICTIM_LATENCY;
+                if (recall(addr) && levels[0]->lookup(addr, data))
+                {
+                    victim_hits++;
+                    access.level = 0;
+                    return access;
+                }
+                victim_misses++;
+            }
+        }
+        return access;
+    }
+
+    /**
+     * Keep the block L1 just evicted for the event log, unless a prefetch evicted it
+     */
+    void note_eviction()
+    {
+        if (LOG_EVICTIONS && !prefetching && victim.valid)
+        {
+            l1_evicted = victim.addr;
+        }
+    }
+
+    /**
+     * Swap the block of an address from the victim cache back into L1, the L1 victim takes its place. The block
+     * moves even if it lacks the word, so no block is ever held by both.
+     * @param addr
+     * @return true if the victim cache held the block
+     */
+    bool recall(const uint32_t addr)
+    {
+        if (!victim_cache->invalidate(addr, &moved))
+        {
+            return false;
+        }
+        victim_swaps++;
+        levels[0]->install(moved, &victim);
+        note_eviction();
+        if (victim.valid) ///< The recall freed an entry, so the victim cache evicts nothing in turn
+        {
+            victim_cache->install(victim);
+        }
+        return true;
+    }
+
+    /**
+     * Put a block evicted from L1 into the victim cache
+     * @param block evicted block, receives the block the victim cache evicts in turn (block.valid tells if any)
+     */
+    void spill(CacheBlock& block)
+    {
+        victim_cache->install(block, &spilled);
+        std::swap(block, spilled);
+    }
+
+    /**
+     * Bring a word that was found in a lower level into the levels above it
+     * @param addr
+     * @param data
+     * @param level level that held the word
+     */
+    void promote(const uint32_t addr, const uint32_t data, const unsigned level)
+    {
+        if (INCLUSION == INCLUSION_EXCLUSIVE)
+        {
+            pull_up(addr);
+            return;
+        }
+        place(addr, data, level, false);
+    }
+
+    /**
+     * Store a word in the levels above a given level, bottom first.
+     * Every inclusion policy brings the same words into L1: an exclusive hierarchy moves the whole block of the word
+     * up from the level holding it, the others store the word and then fill each level from the one below it with
+     * the valid words of the block. L1 therefore hits equally often whatever the inclusion policy.
+     * @param addr
+     * @param data
+     * @param below first level that is not written (NUM_LEVELS writes every level)
+     * @param dirty mark the word dirty in L1
+     */
+    void place(const uint32_t addr, const uint32_t data, const unsigned below, const bool dirty)
+    {
+        if (INCLUSION == INCLUSION_EXCLUSIVE)
+        {
+            // Only L1 receives words, a block partly held below moves up first and victims move one level down
+            pull_up(addr);
+            levels[0]->update(addr, data, tracks_victims(0) || prefetching || LOG_EVICTIONS ? &victim : nullptr, dirty);
+            note_eviction();
+            if (prefetching && victim.valid)
+            {
+                record_polluter(victim.addr);
+            }
+            cascade(0);
+            return;
+        }
+        for (unsigned i = below; i-- > 0;)
+        {
+            const bool track = tracks_victims(i) || ((prefetching || LOG_EVICTIONS) && i == 0);
+            levels[i]->update(addr, data, track ? &victim : nullptr, dirty && i == 0);
+            if (track && victim.valid)
+            {
+                if (i == 0)
+                {
+                    note_eviction();
+                }
+                if (prefetching && i == 0)
+                {
+                    record_polluter(victim.addr);
+                }
+                if (i == 0 && victim_cache)
+                {
+                    spill(victim);
+                }
+                if (victim.valid && victim.dirty)
+                {
+                    write_back(i, victim);
+                }
+                if (INCLUSION == INCLUSION_INCLUSIVE && i > 0)
+                {
+                    back_invalidate(i, victim.addr);
+                }
+            }
+        }
+        for (unsigned i = std::min(below, NUM_LEVELS - 1); i-- > 0;) ///< Bottom up, each level from a filled one
+        {
+            if (levels[i + 1]->copy_block(addr, moved))
+            {
+                levels[i]->fill_missing(moved);
+            }
+        }
+    }
+
+    /**
+     * Move the block of an address from the lower level holding it into L1 (exclusive hierarchy)
+     * @param addr
+     */
+    void pull_up(const uint32_t addr)
+    {
+        for (unsigned i = 1; i < NUM_LEVELS; ++i)
+        {
+            if (levels[i]->invalidate(addr, &moved))
+            {
+                levels[0]->install(moved, &victim);
+                note_eviction();
+                cascade(0);
+                return;
+            }
+        }
+    }
+
+    /**
+     * Move the victim of a level one level down, repeating for the victims this creates, a dirty victim of the last
+     * level is written back (exclusive hierarchy). Victims of L1 pass through the victim cache first.
+     * @param level level that produced the victim
+     */
+    void cascade(unsigned level)
+    {
+        if (level == 0 && victim_cache && victim.valid)
+        {
+            spill(victim);
+        }
+        while (victim.valid && level + 1 < NUM_LEVELS)
+        {
+            moved = victim;
+            levels[++level]->install(moved, &victim);
+        }
+        if (victim.valid && victim.dirty)
+        {
+            write_back(level, victim);
+        }
+    }
+
+    /**
+     * Drop a block evicted from a level from all levels above it (inclusive hierarchy)
+     * @param level level that evicted the block
+     * @param addr base address of the block
+     */
+    void back_invalidate(const unsigned level, const uint32_t addr)
+    {
+        // Bottom up, so the newer copies of the upper levels are written last. A dropped block can be larger than
+        // the evicted one, the rest of its words go to the level right below it.
+        const uint64_t end = static_cast<uint64_t>(addr) + levels[level]->CACHE_LINE_SIZE;
+        for (unsigned i = level; i-- > 0;)
+        {
+            const uint64_t size = levels[i]->CACHE_LINE_SIZE;
+            for (uint64_t block = addr & ~(size - 1); block < end; block += size)
+            {
+                // The victim cache counts as part of L1
+                const bool held = levels[i]->invalidate(static_cast<uint32_t>(block), &dropped)
+                    || (i == 0 && victim_cache && victim_cache->invalidate(static_cast<uint32_t>(block), &dropped));
+                if (held)
+                {
+                    stats[i].backInvalidations++;
+                    if (dropped.dirty) ///< Newer than the evicted block, so written after it
+                    {
+                        write_back(i, dropped);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Write the valid words of a dirty block leaving a level into the next lower level holding its block, or into
+     * memory if there is none. Lower levels may hold stale copies, the first level holding a word is the one read.
+     * @param level level the block leaves
+     * @param block
+     */
+    void write_back(const unsigned level, const CacheBlock& block)
+    {
+        // The words going to memory are issued together and the request waits for the last one
+        const size_t issue = clock + elapsed;
+        size_t done = issue;
+        bool to_memory = false;
+        for (uint32_t offset = 0; offset < block.data.size(); ++offset)
+        {
+            if (block.word_valid(offset) && !write_into_block(block.addr + offset, block.data[offset], level + 1))
+            {
+                write_to_memory(block.addr + offset, block.data[offset]);
+                if (dram)
+                {
+                    done = std::max(done, dram->access(block.addr + offset, issue));
+                }
+                to_memory = true;
+            }
+        }
+        if (to_memory)
+        {
+            writebacks++;
+            elapsed += dram ? done - issue : MEMORY_LATENCY;
+        }
+    }
+
+    /**
+     * Write a word as dirty into the first level at or below a given level that holds its block, without allocating
+     * @param addr
+     * @param data
+     * @param level first level to look at
+     * @return false if no level holds the block
+     */
+    bool write_into_block(const uint32_t addr, const uint32_t data, const unsigned level)
+    {
+        for (unsigned i = level; i < NUM_LEVELS; ++i)
+        {
+            if (levels[i]->contains(addr))
+            {
+                levels[i]->update(addr, data, nullptr, true);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Queue a word for memory
+     * @param addr
+     * @param data
+     */
+    void write_to_memory(const uint32_t addr, const uint32_t data)
+    {
+        memory_writes.push_back(MemoryWrite{addr, data});
+        memory_word_writes++;
+    }
+};
+
+#endif //CACHEHIERARCHY_H
@@ -0,0 +1,149 @@
+#ifndef CACHESTORAGE_H
+#define CACHESTORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Structure-of-arrays storage of all cache lines.
+ * Tags, block-present and dirty flags and per-word valid bits live in flat arrays indexed by line, so a lookup touches
+ * a few contiguous words instead of chasing a pointer per line. The data words are kept in fixed-size pages that are
+ * only allocated when one of their lines is written for the first time, so a large cache costs next to nothing until
+ * it is actually used.
+ */
+class CacheStorage
+{
+public:
+    const unsigned CACHE_LINES; ///< Number of Cache Lines
+    const unsigned CACHE_LINE_SIZE; ///< Number of data words per Cache Line
+    const unsigned VALID_WORDS; ///< Number of 64 bit valid masks per Cache Line
+    const unsigned LINES_PER_PAGE; ///< Number of Cache Lines sharing one data page
+
+    /**
+     * Constructor of the Storage
+     * @param cacheLines
+     * @param cacheLineSize
+     */
+    CacheStorage(const unsigned cacheLines, const unsigned cacheLineSize) :
+        CACHE_LINES(cacheLines),
+        CACHE_LINE_SIZE(cacheLineSize),
+        VALID_WORDS((cacheLineSize + 63) / 64),
+        LINES_PER_PAGE(cacheLineSize < PAGE_WORDS ? PAGE_WORDS / cacheLineSize : 1),
+        tags(cacheLines, 0),
+        present(cacheLines, 0),
+        dirty(cacheLines, 0),
+        valid(static_cast<size_t>(cacheLines) * VALID_WORDS, 0),
+        pages((cacheLines + LINES_PER_PAGE - 1) / LINES_PER_PAGE)
+    {
+    }
+
+    uint32_t tag(const unsigned line) const { return tags[line]; }
+
+    bool is_present(const unsigned line) const { return present[line] != 0; }
+
+    bool is_dirty(const unsigned line) const { return dirty[line] != 0; }
+
+    /**
+     * Mark a line as modified since it was filled, so it has to be written back when it leaves the cache
+     * @param line
+     */
+    void set_dirty(const unsigned line) { dirty[line] = 1; }
+
+    bool is_valid(const unsigned line, const uint32_t offset) const
+    {
+        return (valid[static_cast<size_t>(line) * VALID_WORDS + offset / 64] >> (offset % 64)) & 1;
+    }
+
+    /**
+     * Read a data word, only meaningful if the word is valid
+     * @param line
+     * @param offset
+     * @return data word
+     */
+    uint32_t read(const unsigned line, const uint32_t offset) const
+    {
+        return pages[line / LINES_PER_PAGE][static_cast<size_t>(line % LINES_PER_PAGE) * CACHE_LINE_SIZE + offset];
+    }
+
+    /**
+     * Write a data word and mark it valid, allocating the line's data page on first touch
+     * @param line
+     * @param offset
+     * @param data
+     */
+    void write(const unsigned line, const uint32_t offset, const uint32_t data)
+    {
+        std::unique_ptr<uint32_t[]>& page = pages[line / LINES_PER_PAGE];
+        if (!page)
+        {
+            page.reset(new uint32_t[static_cast<size_t>(LINES_PER_PAGE) * CACHE_LINE_SIZE]);
+        }
+        page[static_cast<size_t>(line % LINES_PER_PAGE) * CACHE_LINE_SIZE + offset] = data;
+        valid[static_cast<size_t>(line) * VALID_WORDS + offset / 64] |= uint64_t{1} << (offset % 64);
+    }
+
+    /**
+     * Copy the valid words of a line out
+     * @param line
+     * @param mask receives VALID_WORDS valid masks
+     * @param data receives CACHE_LINE_SIZE words, only the valid ones are meaningful
+     */
+    void copy_out(const unsigned line, std::vector<uint64_t>& mask, std::vector<uint32_t>& data) const
+    {
+        mask.assign(valid.begin() + static_cast<ptrdiff_t>(line) * VALID_WORDS,
+                    valid.begin() + static_cast<ptrdiff_t>(line + 1) * VALID_WORDS);
+        data.resize(CACHE_LINE_SIZE);
+        for (uint32_t offset = 0; offset < CACHE_LINE_SIZE; ++offset)
+        {
+            if (is_valid(line, offset))
+            {
+                data[offset] = read(line, offset);
+            }
+        }
+    }
+
+    /**
+     * Assign a line to a new block, clearing all of its valid bits
+     * @param line
+     * @param tag
+     */
+    void assign(const unsigned line, const uint32_t tag)
+    {
+        tags[line] = tag;
+        present[line] = 1;
+        dirty[line] = 0;
+        clear_valid(line);
+    }
+
+    /**
+     * Drop the block held by a line
+     * @param line
+     */
+    void invalidate(const unsigned line)
+    {
+        present[line] = 0;
+        dirty[line] = 0;
+        clear_valid(line);
+    }
+
+private:
+    static constexpr unsigned PAGE_WORDS = 16384; ///< Data words per page (64 KiB)
+
+    std::vector<uint32_t> tags; ///< Tag of each line
+    std::vector<uint8_t> present; ///< Whether a line holds a block at all
+    std::vector<uint8_t> dirty; ///< Whether a line was written since it was filled (write back)
+    std::vector<uint64_t> valid; ///< Valid bit of each data word, VALID_WORDS masks per line
+    std::vector<std::unique_ptr<uint32_t[]>> pages; ///< Lazily allocated data pages
+
+    void clear_valid(const unsigned line)
+    {
+        for (unsigned i = 0; i < VALID_WORDS; ++i)
+        {
+            valid[static_cast<size_t>(line) * VALID_WORDS + i] = 0;
+        }
+    }
+};
+
+#endif //CACHESTORAGE_H
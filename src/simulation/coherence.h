@@ -0,0 +1,472 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "cacheEngine.h"
+#include "pagedMemory.h"
+#include "simulation.h"
+
+/**
+ * Coherence state of a block in one private cache
+ */
+enum class LineState : uint8_t
+{
+    INVALID,
+    SHARED, ///< Clean, other caches may hold it as well
+    EXCLUSIVE, ///< Clean, no other cache holds it
+    OWNED, ///< Dirty, other caches may hold it clean, this one writes it back (MOESI only)
+    MODIFIED ///< Dirty, no other cache holds it
+};
+
+/**
+ * Outcome of one access of a core
+ */
+struct CoreAccess
+{
+    bool hit; ///< Whether the core's cache served the access without a coherence transaction
+    size_t cycles; ///< Cycles the access took on the core's clock
+};
+
+/**
+ * Private write-back, write-allocate L1 caches of several cores in front of a shared memory, kept coherent with MESI
+ * or MOESI. The states of the cached blocks are kept in one table indexed by block, which is the directory of a
+ * directory protocol and stands in for the snoop responses of a bus, the interconnect only decides what the
+ * transactions cost.
+ * Like the rest of the model the caches hold valid bits per word. Every valid copy of a word holds its newest value:
+ * a write invalidates all other copies first, and a dirty copy (M or O) is the only place a word can be newer than
+ * memory. A miss takes the word from the dirty copy if that holds it, otherwise from memory.
+ * The cores run in trace order, each on its own clock. A bus serializes the transactions of all cores, a directory
+ * adds a round trip to the caches it has to contact.
+ * @tparam Policy replacement policy, see replacementPolicy.h
+ */
+template <class Policy>
+class CoherentCaches
+{
+public:
+    const unsigned NUM_CORES; ///< Number of cores, one private cache each
+    const unsigned CACHE_LATENCY; ///< Latency of a private cache in Cycles
+    const unsigned MEMORY_LATENCY; ///< Latency of the Memory in Cycles
+    const unsigned COHERENCE_LATENCY; ///< Cycles of a bus transaction or of one directory round trip
+    const CoherenceProtocol PROTOCOL; ///< MESI or MOESI
+    const Interconnect INTERCONNECT; ///< Snooping bus or directory
+
+    /**
+     * Constructor of the Caches
+     * @param config L1 configuration of every core, number of cores, protocol, interconnect and latencies
+     * @param memory shared memory
+     */
+    CoherentCaches(const SimulationConfig& config, PagedMemory& memory) :
+        NUM_CORES(config.cores),
+        CACHE_LATENCY(config.levels[0].latency),
+        MEMORY_LATENCY(config.memoryLatency),
+        COHERENCE_LATENCY(config.coherenceLatency),
+        PROTOCOL(static_cast<CoherenceProtocol>(config.coherence)),
+        INTERCONNECT(static_cast<Interconnect>(config.interconnect)),
+        memory(memory),
+        clocks(config.cores, 0),
+        hits(config.cores, 0),
+        misses(config.cores, 0)
+    {
+        const CacheLevelConfig& level = config.levels[0];
+        for (unsigned core = 0; core < NUM_CORES; ++core)
+        {
+            caches.emplace_back(new CacheEngine<Policy>(level.cacheLines, level.cacheLineSize, level.ways));
+        }
+    }
+
+    /**
+     * Read a word
+     * @param core
+     * @param addr
+     * @param data receives the word
+     * @return whether the core's cache held the word and the cycles
+     */
+    CoreAccess read(const unsigned core, const uint32_t addr, uint32_t& data)
+    {
+        elapsed = CACHE_LATENCY;
+        if (caches[core]->lookup(addr, data))
+        {
+            touch(core, addr);
+            return finish(core, true);
+        }
+
+        Entry& entry = entry_of(block_of(addr));
+        const LineState state = entry.state[core];
+        const int owner = dirty_holder(entry, core);
+        bool forwarded = false;
+        if (state == LineState::INVALID) ///< Join the holders of the block
+        {
+            unsigned contacted = 0;
+            for (unsigned other = 0; other < NUM_CORES; ++other)
+            {
+                contacted += other != core && entry.state[other] != LineState::INVALID &&
+                    entry.state[other] != LineState::SHARED;
+            }
+            transaction(core, contacted);
+            forwarded = owner >= 0 && caches[owner]->peek(addr, data);
+            downgrade(entry, core, block_of(addr));
+            entry.state[core] = holders(entry, core) ? LineState::SHARED : LineState::EXCLUSIVE;
+        }
+        else if (state == LineState::SHARED) ///< A dirty copy elsewhere may hold the word
+        {
+            transaction(core, owner >= 0);
+            forwarded = owner >= 0 && caches[owner]->peek(addr, data);
+        }
+        if (forwarded)
+        {
+            cache_to_cache++;
+        }
+        else ///< Nobody holds the word dirty, so memory has its newest value
+        {
+            data = memory.read(addr);
+            memory_reads++;
+            elapsed += MEMORY_LATENCY;
+        }
+
+        fill(core, addr, data);
+        return finish(core, false);
+    }
+
+    /**
+     * Write a word, invalidating every other copy of its block first
+     * @param core
+     * @param addr
+     * @param data
+     * @return whether the core could write without a coherence transaction and the cycles
+     */
+    CoreAccess write(const unsigned core, const uint32_t addr, const uint32_t data)
+    {
+        elapsed = CACHE_LATENCY;
+        Entry& entry = entry_of(block_of(addr));
+        const LineState state = entry.state[core];
+        const bool hit = state == LineState::MODIFIED || state == LineState::EXCLUSIVE;
+        if (!hit) ///< Read for ownership or upgrade
+        {
+            transaction(core, holders(entry, core));
+            for (unsigned other = 0; other < NUM_CORES; ++other)
+            {
+                if (other != core && entry.state[other] != LineState::INVALID)
+                {
+                    invalidate(entry, other, addr);
+                }
+            }
+        }
+        entry.state[core] = LineState::MODIFIED;
+        fill(core, addr, data);
+        return finish(core, hit);
+    }
+
+    /**
+     * @return cycles until the last core finished
+     */
+    size_t cycles() const
+    {
+        return *std::max_element(clocks.begin(), clocks.end());
+    }
+
+    /**
+     * Write the statistics of all cores, the coherence traffic and the most invalidated lines into a result
+     * @param result
+     */
+    void report(Result& result) const
+    {
+        result.numLevels = 1;
+        result.numCores = NUM_CORES;
+        for (unsigned core = 0; core < NUM_CORES; ++core)
+        {
+            result.levels[0].hits += hits[core];
+            result.levels[0].misses += misses[core];
+            result.levels[0].evictions += caches[core]->evictions();
+            result.coreCycles[core] = clocks[core];
+        }
+        const size_t lookups = result.levels[0].hits + result.levels[0].misses;
+        const double miss_rate = lookups ? static_cast<double>(result.levels[0].misses) / lookups : 0.0;
+        result.levels[0].amat = CACHE_LATENCY + miss_rate * MEMORY_LATENCY;
+        result.amat = result.levels[0].amat;
+        result.memoryReads = memory_reads;
+        result.memoryWrites = memory_word_writes;
+        result.writebacks = writebacks;
+        result.coherenceMessages = messages;
+        result.invalidations = invalidations;
+        result.cacheToCacheTransfers = cache_to_cache;
+        result.falseSharingInvalidations = false_sharing;
+
+        std::vector<HotLine> lines;
+        lines.reserve(sharing.size());
+        for (const auto& line : sharing)
+        {
+            lines.push_back(HotLine{line.first, line.second.invalidations, line.second.falseSharing});
+        }
+        const size_t count = std::min<size_t>(lines.size(), MAX_HOT_LINES);
+        std::partial_sort(lines.begin(), lines.begin() + count, lines.end(), [](const HotLine& a, const HotLine& b)
+        {
+            return a.invalidations != b.invalidations ? a.invalidations > b.invalidations : a.addr < b.addr;
+        });
+        result.numHotLines = static_cast<unsigned>(count);
+        std::copy(lines.begin(), lines.begin() + count, result.hotLines);
+    }
+
+private:
+    /**
+     * States of a block in all caches, only kept while at least one cache holds it
+     */
+    struct Entry
+    {
+        std::vector<LineState> state; ///< State of the block in each cache
+        std::vector<uint64_t> touched; ///< Words each cache accessed since it got the block, offset modulo 64
+    };
+
+    /**
+     * How often the copies of a line were invalidated
+     */
+    struct Sharing
+    {
+        size_t invalidations; ///< Copies invalidated
+        size_t falseSharing; ///< Copies invalidated that never accessed the word written
+    };
+
+    PagedMemory& memory; ///< Shared memory
+    std::vector<std::unique_ptr<CacheEngine<Policy>>> caches; ///< Private cache of each core
+    std::unordered_map<uint32_t, Entry> directory; ///< Block -> states of its copies
+    std::unordered_map<uint32_t, Sharing> sharing; ///< Block -> invalidations, only blocks that were invalidated
+    std::vector<size_t> clocks; ///< Cycles each core has spent
+    std::vector<size_t> hits; ///< Hits of each core
+    std::vector<size_t> misses; ///< Misses of each core
+    CacheBlock victim; ///< Block evicted by the current fill
+    CacheBlock dropped; ///< Block dropped by an invalidation
+    size_t elapsed = 0; ///< Cycles the current access has taken so far
+    size_t bus_free = 0; ///< Cycle the bus is free again
+    size_t messages = 0; ///< Bus transactions or directory messages
+    size_t invalidations = 0; ///< Copies invalidated
+    size_t false_sharing = 0; ///< Copies invalidated that never accessed the word written
+    size_t cache_to_cache = 0; ///< Words taken from the dirty copy of another cache
+    size_t memory_reads = 0; ///< Words read from memory
+    size_t memory_word_writes = 0; ///< Words written to memory
+    size_t writebacks = 0; ///< Dirty blocks written back to memory
+
+    uint32_t block_of(const uint32_t addr) const { return addr & ~(caches[0]->CACHE_LINE_SIZE - 1); }
+
+    uint64_t word_bit(const uint32_t addr) const { return uint64_t{1} << ((addr - block_of(addr)) % 64); }
+
+    static bool dirty(const LineState state) { return state == LineState::MODIFIED || state == LineState::OWNED; }
+
+    Entry& entry_of(const uint32_t block)
+    {
+        Entry& entry = directory[block];
+        if (entry.state.empty())
+        {
+            entry.state.assign(NUM_CORES, LineState::INVALID);
+            entry.touched.assign(NUM_CORES, 0);
+        }
+        return entry;
+    }
+
+    /**
+     * Number of other caches holding a block
+     * @param entry
+     * @param core
+     * @return caches other than the core's holding the block
+     */
+    unsigned holders(const Entry& entry, const unsigned core) const
+    {
+        unsigned count = 0;
+        for (unsigned other = 0; other < NUM_CORES; ++other)
+        {
+            count += other != core && entry.state[other] != LineState::INVALID;
+        }
+        return count;
+    }
+
+    /**
+     * Other cache holding a block dirty
+     * @param entry
+     * @param core
+     * @return core of that cache or -1
+     */
+    int dirty_holder(const Entry& entry, const unsigned core) const
+    {
+        for (unsigned other = 0; other < NUM_CORES; ++other)
+        {
+            if (other != core && dirty(entry.state[other]))
+            {
+                return static_cast<int>(other);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Pay for a coherence transaction of a core
+     * @param core
+     * @param contacted other caches that have to forward data or invalidate their copy
+     */
+    void transaction(const unsigned core, const unsigned contacted)
+    {
+        if (INTERCONNECT == INTERCONNECT_BUS) ///< One broadcast, all caches snoop it
+        {
+            const size_t start = std::max(clocks[core] + elapsed, bus_free);
+            bus_free = start + COHERENCE_LATENCY;
+            elapsed = bus_free - clocks[core];
+            messages++;
+            return;
+        }
+        // Request and reply, plus a message and its acknowledgement per contacted cache, sent in parallel
+        elapsed += COHERENCE_LATENCY + (contacted ? COHERENCE_LATENCY : 0);
+        messages += 2 + 2 * static_cast<size_t>(contacted);
+    }
+
+    /**
+     * Let the other holders of a block know that a core reads it: exclusive copies become shared, a modified copy is
+     * written back and becomes shared (MESI) or stays dirty as the owner (MOESI)
+     * @param entry
+     * @param core
+     * @param block base address of the block
+     */
+    void downgrade(Entry& entry, const unsigned core, const uint32_t block)
+    {
+        for (unsigned other = 0; other < NUM_CORES; ++other)
+        {
+            LineState& state = entry.state[other];
+            if (other == core || state == LineState::INVALID)
+            {
+                continue;
+            }
+            if (state == LineState::EXCLUSIVE)
+            {
+                state = LineState::SHARED;
+            }
+            else if (state == LineState::MODIFIED && PROTOCOL == COHERENCE_MOESI)
+            {
+                state = LineState::OWNED;
+            }
+            else if (state == LineState::MODIFIED)
+            {
+                flush(other, block);
+                state = LineState::SHARED;
+            }
+        }
+    }
+
+    /**
+     * Drop the copy of a block another core is about to write
+     * @param entry
+     * @param other core holding the copy
+     * @param addr address written
+     */
+    void invalidate(Entry& entry, const unsigned other, const uint32_t addr)
+    {
+        const uint32_t block = block_of(addr);
+        caches[other]->invalidate(block, &dropped);
+        if (dirty(entry.state[other]))
+        {
+            write_back(dropped);
+        }
+        invalidations++;
+        Sharing& line = sharing[block];
+        line.invalidations++;
+        if (!(entry.touched[other] & word_bit(addr)))
+        {
+            false_sharing++;
+            line.falseSharing++;
+        }
+        entry.state[other] = LineState::INVALID;
+        entry.touched[other] = 0;
+    }
+
+    /**
+     * Place a word in a core's cache and release the block it evicts
+     * @param core
+     * @param addr
+     * @param data
+     */
+    void fill(const unsigned core, const uint32_t addr, const uint32_t data)
+    {
+        caches[core]->update(addr, data, &victim);
+        touch(core, addr);
+        if (!victim.valid)
+        {
+            return;
+        }
+        const auto it = directory.find(victim.addr);
+        if (dirty(it->second.state[core]))
+        {
+            write_back(victim);
+            elapsed += MEMORY_LATENCY;
+            messages++;
+        }
+        it->second.state[core] = LineState::INVALID;
+        it->second.touched[core] = 0;
+        if (!holders(it->second, core))
+        {
+            directory.erase(it);
+        }
+    }
+
+    /**
+     * Write the valid words of a core's dirty copy to memory, the copy stays cached
+     * @param core
+     * @param block
+     */
+    void flush(const unsigned core, const uint32_t block)
+    {
+        uint32_t data = 0;
+        for (uint32_t offset = 0; offset < caches[core]->CACHE_LINE_SIZE; ++offset)
+        {
+            if (caches[core]->peek(block + offset, data))
+            {
+                memory.write(block + offset, data);
+                memory_word_writes++;
+            }
+        }
+        writebacks++;
+    }
+
+    /**
+     * Write the valid words of a dirty block that left a cache to memory
+     * @param block
+     */
+    void write_back(const CacheBlock& block)
+    {
+        for (uint32_t offset = 0; offset < block.data.size(); ++offset)
+        {
+            if (block.word_valid(offset))
+            {
+                memory.write(block.addr + offset, block.data[offset]);
+                memory_word_writes++;
+            }
+        }
+        writebacks++;
+    }
+
+    /**
+     * Remember that a core accessed a word of a block it holds
+     * @param core
+     * @param addr
+     */
+    void touch(const unsigned core, const uint32_t addr)
+    {
+        const auto it = directory.find(block_of(addr));
+        it->second.touched[core] |= word_bit(addr);
+    }
+
+    /**
+     * Add the cycles of an access to the core's clock and count it
+     * @param core
+     * @param hit
+     * @return outcome of the access
+     */
+    CoreAccess finish(const unsigned core, const bool hit)
+    {
+        clocks[core] += elapsed;
+        (hit ? hits : misses)[core]++;
+        return CoreAccess{hit, elapsed};
+    }
+};
+
+#endif //COHERENCE_H
@@ -1,11 +1,15 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <cstdio>
+#include <memory>
 #include <systemc>
 
 #include "cache.h"
+#include "eventLog.h"
 #include "memory.h"
 #include "primitiveGateCountCalc.h"
+#include "statisticsCollector.h"
 
 using namespace sc_core;
 
@@ -36,7 +40,8 @@ public:
     sc_out<size_t> cycles_; ///< Cycles Signal
     sc_out<size_t> primitiveGateCount; ///< Primitive Gate Count Signal
 
-    const bool DIRECT_MAPPED; ///< boolean flag for cache mapping
+    const size_t GATE_COUNT; ///< Primitive gate count of the cache hierarchy
+    const bool STORE_READ_DATA; ///< Whether the data read is stored into the requests
     size_t cycles; ///< Number of Cycles
     size_t request_counter; ///< Request Counter
 
@@ -46,33 +51,33 @@ public:
     /**
      * Controller Module Constructor
      * @param name
-     * @param directMapped
+     * @param config
      * @param requests
      * @param num_requests
-     * @param cacheLines
-     * @param cacheLineSize
-     * @param cacheLatency
-     * @param memoryLatency
      */
-    Controller(sc_module_name name, const bool directMapped, struct Request* requests,
-               const size_t num_requests, const unsigned cacheLines, const unsigned cacheLineSize,
-               const unsigned cacheLatency,
-               const unsigned memoryLatency) :
+    Controller(sc_module_name name, const SimulationConfig& config, struct Request* requests,
+               const size_t num_requests) :
         sc_module(name),
-        DIRECT_MAPPED(directMapped),
+        GATE_COUNT(::hierarchyGateCount(config)),
+        STORE_READ_DATA(!config.discardReadData),
         cycles(0),
         request_counter(0),
         requests(requests),
         num_requests(num_requests),
         hit_count(0),
-        miss_count(0)
+        miss_count(0),
+        statistics(config)
     {
         // Defining the process of the Module
         SC_THREAD(controller_process);
 
         // Create instances of Cache and Memory
-        cache = new Cache("cache", cacheLines, cacheLineSize, cacheLatency, memoryLatency, DIRECT_MAPPED);
-        memory = new Memory("memory");
+        cache = create_cache("cache", config);
+        memory = new Memory("memory", config.mmapMemory != 0);
+        if (config.eventLog)
+        {
+            event_log.reset(new EventLog(config.eventLog, config.eventFilter));
+        }
 
         // Drive the signals
         cache->clk(clk);
@@ -103,6 +108,21 @@ public:
         delete memory;
     }
 
+    /**
+     * Write the per-level statistics of the cache hierarchy and the request statistics into a result, closing the
+     * event log
+     * @param result
+     */
+    void report(Result& result) const
+    {
+        cache->report(result);
+        statistics.report(result);
+        if (event_log)
+        {
+            result.loggedEvents = event_log->close();
+        }
+    }
+
     void trace_signals(sc_trace_file* trace_file) const
     {
         sc_trace(trace_file, clk, "clk");
@@ -125,11 +145,13 @@ public:
 private:
     Cache* cache; ///< Cache Module
     Memory* memory; ///< Memory Module
+    std::unique_ptr<EventLog> event_log; ///< Log of the requests, null if none is written
     struct Request* requests; ///< Array of Requests
 
     size_t num_requests; ///< Number of Requests
     size_t hit_count; ///< Hit Counter
     size_t miss_count; ///< Miss Counter
+    StatisticsCollector statistics; ///< Latencies, hit rates and hit rate series of the requests
 
     /**
      * Process of the Controller Module that orchestrates the Cache and Memory Modules
@@ -146,12 +168,21 @@ private:
 
             // Wait for the Cache to process the request and get the result
             wait(cache->finishedProcessingEvent);
-            if (!request.we)
+            if (!request.we && STORE_READ_DATA)
             {
                 requests[request_counter].data = rdata.read();
-                // std::printf("Read Data: %u\n", rdata.read());
             }
+#if DEBUG_LEVEL >= 2
+            std::printf("Request %zu: Addr = %u, WE = %d, Hit = %d, Cycles = %zu, Read Data = %u\n", request_counter,
+                        request.addr, request.we, hit.read(), cycles_per_request.read(), rdata.read());
+#endif
 
+            if (event_log && event_log->accepts(request_counter, cycles, request.addr, hit.read()))
+            {
+                event_log->record(request_counter, cycles, request.addr, request.we, cache->last_level(),
+                                  cycles_per_request.read(), cache->last_eviction());
+            }
+            statistics.record(request.addr, request.we, hit.read(), cycles_per_request.read());
             cycles += cycles_per_request.read(); ///< Increment the number of cycles per request
             if (hit.read()) ///< Check for hit or miss
             {
@@ -171,32 +202,23 @@ private:
         // std::cout << "Total Hits: " << hit_count << std::endl;
         // std::cout << "Total Misses: " << miss_count << std::endl;
         // std::cout << "Total Cycles: " << cycles << std::endl;
-        // std::cout << "Primitive Gate Count: " << ::primitiveGateCount(cache->CACHE_LINES, cache->CACHE_LINE_SIZE,
-        //                                                               cache->TAG_BITS, cache->INDEX_BITS,
-        //                                                                DIRECT_MAPPED) << std::endl;
+        // std::cout << "Primitive Gate Count: " << GATE_COUNT << std::endl;
         total_hits.write(hit_count); ///< Write the total hits to the output signal
         total_misses.write(miss_count); ///< Write the total misses to the output signal
         cycles_.write(cycles); ///< Write the total cycles to the output signal
-        primitiveGateCount.write(::primitiveGateCount(cache->CACHE_LINES, cache->CACHE_LINE_SIZE, cache->TAG_BITS,
-                                                      cache->INDEX_BITS,
-                                                      DIRECT_MAPPED)); ///< Calculate and write the primitive gate count
+        primitiveGateCount.write(GATE_COUNT); ///< Calculate and write the primitive gate count
         requests_out.write(requests);
     }
 
     void is_process_finished()
     {
-        // std::cout << "Request Counter: " << request_counter << std::endl;
-        // std::cout << "Num Requests: " << num_requests << std::endl;
-        // std::cout << "Cycles: " << cycles << std::endl;
         if (request_counter >= num_requests)
         {
             // std::cout << "Simulation finished, all requests processed" << std::endl;
             total_hits.write(hit_count);
             total_misses.write(miss_count);
             cycles_.write(cycles);
-            primitiveGateCount.write(::primitiveGateCount(cache->CACHE_LINES, cache->CACHE_LINE_SIZE, cache->TAG_BITS,
-                                                          cache->INDEX_BITS,
-                                                          DIRECT_MAPPED));
+            primitiveGateCount.write(GATE_COUNT);
             requests_out.write(requests);
             sc_stop();
         }
@@ -210,9 +232,7 @@ private:
             total_hits.write(hit_count);
             total_misses.write(miss_count);
             cycles_.write(SIZE_MAX);
-            primitiveGateCount.write(::primitiveGateCount(cache->CACHE_LINES, cache->CACHE_LINE_SIZE, cache->TAG_BITS,
-                                                          cache->INDEX_BITS,
-                                                          DIRECT_MAPPED));
+            primitiveGateCount.write(GATE_COUNT);
             requests_out.write(requests);
             sc_stop();
         }
@@ -0,0 +1,118 @@
+#ifndef DRAMMODEL_H
+#define DRAMMODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simulation.h"
+
+/**
+ * Timing model of a DRAM behind the cache hierarchy.
+ * Consecutive addresses fill a row, consecutive rows are spread over the channels and then the banks of a channel.
+ * An access waits until its bank is free, opens its row if needed (precharging a different open row first) and
+ * then waits for its channel's data bus, which transfers one word per burst. Under the open-page policy a row stays
+ * open for later hits, under the closed-page policy it is precharged right after the access.
+ * All times are absolute cycles, so requests that overlap compete for banks and buses.
+ */
+class DramModel
+{
+public:
+    const unsigned CHANNELS; ///< Number of channels, each with its own data bus
+    const unsigned BANKS; ///< Number of banks per channel
+    const unsigned ROW_SIZE; ///< Number of addresses per row
+    const unsigned T_RCD; ///< Cycles from activating a row to reading a column
+    const unsigned T_CAS; ///< Cycles from reading a column to the data
+    const unsigned T_RP; ///< Cycles to precharge (close) a row
+    const unsigned T_BURST; ///< Cycles the data bus is busy per word
+    const PagePolicy PAGE_POLICY; ///< Open-page or closed-page
+
+    /**
+     * Constructor of the Model
+     * @param config
+     */
+    explicit DramModel(const DramConfig& config) :
+        CHANNELS(config.channels),
+        BANKS(config.banks),
+        ROW_SIZE(config.rowSize),
+        T_RCD(config.tRCD),
+        T_CAS(config.tCAS),
+        T_RP(config.tRP),
+        T_BURST(config.tBurst),
+        PAGE_POLICY(static_cast<PagePolicy>(config.pagePolicy)),
+        banks(static_cast<size_t>(config.channels) * config.banks),
+        bus_free(config.channels, 0)
+    {
+    }
+
+    /**
+     * Perform one word access
+     * @param addr
+     * @param issue cycle the access is issued
+     * @return cycle the access completes
+     */
+    size_t access(const uint32_t addr, const size_t issue)
+    {
+        const uint32_t row_index = addr / ROW_SIZE;
+        const unsigned channel = row_index % CHANNELS;
+        Bank& bank = banks[static_cast<size_t>(channel) * BANKS + row_index / CHANNELS % BANKS];
+        const uint32_t row = row_index / CHANNELS / BANKS;
+
+        const size_t start = std::max(issue, bank.ready);
+        size_t command = T_CAS;
+        if (bank.open && bank.row == row)
+        {
+            stats.rowHits++;
+        }
+        else if (bank.open)
+        {
+            stats.rowConflicts++;
+            command += T_RP + T_RCD;
+        }
+        else
+        {
+            command += T_RCD;
+        }
+
+        const size_t data_start = std::max(start + command, bus_free[channel]);
+        const size_t done = data_start + T_BURST;
+        bus_free[channel] = done;
+
+        if (PAGE_POLICY == PAGE_OPEN)
+        {
+            bank.open = true;
+            bank.row = row;
+            bank.ready = done;
+        }
+        else
+        {
+            bank.ready = done + T_RP;
+        }
+
+        stats.accesses++;
+        stats.queueCycles += (start - issue) + (data_start - start - command);
+        stats.latencyCycles += done - issue;
+        return done;
+    }
+
+    const DramStats& statistics() const { return stats; }
+
+private:
+    /**
+     * State of one bank
+     */
+    struct Bank
+    {
+        bool open = false; ///< Whether a row is open
+        uint32_t row = 0; ///< Open row
+        size_t ready = 0; ///< Cycle the bank can start the next access
+    };
+
+    std::vector<Bank> banks; ///< Banks, BANKS per channel
+    std::vector<size_t> bus_free; ///< Cycle each channel's data bus becomes free
+    DramStats stats{}; ///< Statistics of all accesses
+};
+
+#endif //DRAMMODEL_H
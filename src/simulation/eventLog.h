@@ -0,0 +1,210 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cacheHierarchy.h"
+#include "simulation.h"
+
+/**
+ * Binary log of the requests of a run, one Event per request that passes the filter.
+ * Every simulating thread appends to a ring buffer of its own, a background writer drains the rings into the file, so
+ * a request costs a filter check and a copy into memory and the simulation only waits for the disk when a ring is
+ * full. Only the owning thread writes the head of a ring and only the writer its tail, neither takes a lock. Events
+ * of one thread are written in order, the events of different threads are interleaved in blocks.
+ */
+class EventLog
+{
+public:
+    static constexpr size_t RING_EVENTS = size_t{1} << 16; ///< Events per ring, a power of two
+
+    /**
+     * Constructor of the Log, starts the writer
+     * @param file log the events are appended to
+     * @param filter requests that are logged
+     */
+    EventLog(FILE* file, const EventFilter& filter) :
+        file(file),
+        filter(filter),
+        id(++instances())
+    {
+        writer = std::thread(&EventLog::write_events, this);
+    }
+
+    ~EventLog()
+    {
+        close();
+    }
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * Whether a request passes the filter
+     * @param request index of the request
+     * @param cycle cycles of the run before the request
+     * @param addr
+     * @param hit whether L1 served the request
+     * @return true if the request is logged
+     */
+    bool accepts(const uint64_t request, const uint64_t cycle, const uint32_t addr, const bool hit) const
+    {
+        return request >= filter.firstRequest && request <= filter.lastRequest && cycle >= filter.firstCycle &&
+            cycle <= filter.lastCycle && addr >= filter.lowAddress && addr <= filter.highAddress &&
+            !(hit && filter.missesOnly);
+    }
+
+    /**
+     * Append an event to the ring of the calling thread, waiting for the writer if the ring is full
+     * @param request index of the request
+     * @param cycle cycles of the run before the request
+     * @param addr
+     * @param we
+     * @param level level that held the word, -1 if none
+     * @param latency cycles the request added to the run
+     * @param evicted base address of the block L1 evicted for the request, NO_BLOCK if none
+     */
+    void record(const uint64_t request, const uint64_t cycle, const uint32_t addr, const bool we, const int level,
+                const size_t latency, const uint64_t evicted)
+    {
+        Ring& ring = local_ring();
+        const size_t head = ring.head.load(std::memory_order_relaxed);
+        while (head - ring.tail.load(std::memory_order_acquire) == RING_EVENTS)
+        {
+            std::this_thread::yield();
+        }
+        Event& event = ring.events[head & (RING_EVENTS - 1)];
+        event.request = request;
+        event.cycle = cycle;
+        event.addr = addr;
+        event.latency = latency < UINT32_MAX ? static_cast<uint32_t>(latency) : UINT32_MAX;
+        event.evicted = evicted != NO_BLOCK ? static_cast<uint32_t>(evicted) : 0;
+        event.we = we;
+        event.level = static_cast<int8_t>(level);
+        event.flags = evicted != NO_BLOCK ? EVENT_EVICTION : 0;
+        event.reserved = 0;
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * Write the remaining events and stop the writer, call it once every thread recording has finished
+     * @return number of events written to the file
+     */
+    size_t close()
+    {
+        if (writer.joinable())
+        {
+            stopping.store(true, std::memory_order_release);
+            writer.join();
+        }
+        return written;
+    }
+
+private:
+    /**
+     * Ring buffer of one recording thread, head and tail on cache lines of their own
+     */
+    struct Ring
+    {
+        std::unique_ptr<Event[]> events{new Event[RING_EVENTS]};
+        char pad0[64];
+        std::atomic<size_t> head{0}; ///< Events recorded, only the owning thread stores it
+        char pad1[64];
+        std::atomic<size_t> tail{0}; ///< Events written, only the writer stores it
+        char pad2[64];
+    };
+
+    FILE* file; ///< Log the events are appended to
+    const EventFilter filter; ///< Requests that are logged
+    const uint64_t id; ///< Number of the log among all logs of the process, identifies it to local_ring
+    std::mutex rings_mutex; ///< Guards rings against threads registering while the writer walks it
+    std::vector<std::unique_ptr<Ring>> rings; ///< One ring per recording thread
+    std::atomic<bool> stopping{false}; ///< Set by close, the writer drains the rings one last time and exits
+    size_t written = 0; ///< Events written to the file, only the writer touches it until it is joined
+    std::thread writer; ///< Background writer
+
+    /**
+     * Counter numbering the logs, so a thread never mistakes a new log for one that was destroyed at the same address
+     * @return the counter
+     */
+    static std::atomic<uint64_t>& instances()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return counter;
+    }
+
+    /**
+     * Ring of the calling thread, created the first time the thread records into this log
+     * @return the ring
+     */
+    Ring& local_ring()
+    {
+        thread_local uint64_t owner = 0; ///< Log the cached ring belongs to
+        thread_local Ring* ring = nullptr;
+        if (owner != id)
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            rings.emplace_back(new Ring);
+            ring = rings.back().get();
+            owner = id;
+        }
+        return *ring;
+    }
+
+    /**
+     * Write the events recorded so far from every ring
+     * @return number of events written
+     */
+    size_t drain()
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        size_t count = 0;
+        for (const std::unique_ptr<Ring>& ring : rings)
+        {
+            const size_t tail = ring->tail.load(std::memory_order_relaxed);
+            const size_t head = ring->head.load(std::memory_order_acquire);
+            if (head == tail)
+            {
+                continue;
+            }
+            const size_t first = tail & (RING_EVENTS - 1);
+            const size_t contiguous = std::min(head - tail, RING_EVENTS - first); ///< Up to the end of the ring
+            count += std::fwrite(&ring->events[first], sizeof(Event), contiguous, file);
+            count += std::fwrite(&ring->events[0], sizeof(Event), head - tail - contiguous, file);
+            ring->tail.store(head, std::memory_order_release);
+        }
+        written += count;
+        return count;
+    }
+
+    /**
+     * Writer thread, drains the rings until the log is closed and sleeps while they are empty
+     */
+    void write_events()
+    {
+        while (true)
+        {
+            // Everything recorded before close is visible once stopping is, so the drain after it is the last one
+            const bool last = stopping.load(std::memory_order_acquire);
+            if (drain() == 0 && !last)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            if (last)
+            {
+                return;
+            }
+        }
+    }
+};
+
+#endif //EVENTLOG_H
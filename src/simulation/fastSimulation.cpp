@@ -0,0 +1,168 @@
+#include "fastSimulation.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "cacheHierarchy.h"
+#include "eventLog.h"
+#include "pagedMemory.h"
+#include "primitiveGateCountCalc.h"
+#include "statisticsCollector.h"
+
+namespace
+{
+    constexpr size_t STREAM_BATCH = 4096; ///< Requests pulled from a RequestSource at a time
+
+    /**
+     * Replay the requests through a hierarchy of one replacement policy, mirroring Controller::controller_process
+     * and PolicyCache::process
+     * @tparam Policy replacement policy, see replacementPolicy.h
+     * @tparam Batches callable storing a pointer to the next requests in its argument and returning their number,
+     * 0 once there are none left
+     * @param config
+     * @param next_batch
+     * @param result receives cycles, hits, misses, the hierarchy and request statistics and the number of events
+     *        logged
+     */
+    template <class Policy, class Batches>
+    void replay(const SimulationConfig& config, Batches&& next_batch, Result& result)
+    {
+        CacheHierarchy<Policy> hierarchy(config);
+        PagedMemory memory(config.mmapMemory != 0); ///< Words written to memory, the rest reads as 0
+        const size_t cycles_max = static_cast<size_t>(config.cycles);
+        std::unique_ptr<EventLog> log(config.eventLog ? new EventLog(config.eventLog, config.eventFilter) : nullptr);
+        StatisticsCollector statistics(config);
+
+        // Perform the words the hierarchy queued for memory
+        const auto drain_writes = [&]()
+        {
+            for (const MemoryWrite& write : hierarchy.pending_writes())
+            {
+                memory.write(write.addr, write.data);
+            }
+            hierarchy.clear_pending_writes();
+        };
+
+        size_t cycles = 0;
+        size_t request_counter = 0;
+        bool out_of_cycles = false;
+        Request* batch = nullptr;
+        size_t batch_size = 0;
+        while (!out_of_cycles && (batch_size = next_batch(batch)) != 0)
+        {
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                if (request_counter != 0 && cycles >= cycles_max) ///< Out of cycles before the last request
+                {
+                    cycles = SIZE_MAX;
+                    out_of_cycles = true;
+                    break;
+                }
+
+                Request& request = batch[i];
+                HierarchyAccess access{};
+                uint32_t data = 0;
+                if (request.we)
+                {
+                    access = hierarchy.write(request.addr, request.data);
+                }
+                else if ((access = hierarchy.read(request.addr, data)).level < 0)
+                {
+                    drain_writes(); ///< Memory has to be up to date before it is read
+                    data = memory.read(request.addr);
+                    access.cycles += hierarchy.fill(request.addr, data);
+                }
+                drain_writes();
+                for (const uint32_t word : hierarchy.issue_prefetches())
+                {
+                    hierarchy.prefetch_fill(word, memory.read(word));
+                }
+                drain_writes(); ///< Dirty blocks the prefetches evicted
+                if (!request.we && !config.discardReadData)
+                {
+                    request.data = data;
+                }
+
+                if (log && log->accepts(request_counter, cycles, request.addr, access.level == 0))
+                {
+                    log->record(request_counter, cycles, request.addr, request.we, access.level, access.cycles,
+                                hierarchy.l1_eviction());
+                }
+#if DEBUG_LEVEL >= 2
+                std::printf("Request %zu: Addr = %u, WE = %d, Level = %d, Cycles = %zu\n", request_counter,
+                            request.addr, request.we, access.level, access.cycles);
+#endif
+                statistics.record(request.addr, request.we, access.level == 0, access.cycles);
+                cycles += access.cycles;
+                if (access.level == 0)
+                {
+                    result.hits++;
+                }
+                else
+                {
+                    result.misses++;
+                }
+                request_counter++;
+            }
+        }
+        result.cycles = cycles;
+        hierarchy.report(result);
+        statistics.report(result);
+        if (log)
+        {
+            result.loggedEvents = log->close();
+        }
+    }
+}
+
+/**
+ * Runs the fast engine
+ * @param config
+ * @param num_Requests
+ * @param requests
+ * @return Result
+ */
+Result run_fast_simulation(const SimulationConfig& config, const size_t num_Requests, Request* requests)
+{
+    Result result{};
+    result.primitiveGateCount = hierarchyGateCount(config);
+    visit_policy(static_cast<ReplacementPolicy>(config.policy), [&](auto type)
+    {
+        using Policy = typename decltype(type)::type;
+        bool taken = false; ///< The array is a single batch
+        replay<Policy>(config, [&](Request*& batch)
+        {
+            batch = requests;
+            const size_t size = taken ? 0 : num_Requests;
+            taken = true;
+            return size;
+        }, result);
+    });
+    return result;
+}
+
+/**
+ * Runs the fast engine on requests pulled from a source into a fixed buffer
+ * @param config
+ * @param source
+ * @param context
+ * @return Result
+ */
+Result run_streaming_simulation(const SimulationConfig* config, const RequestSource source, void* context)
+{
+    Result result{};
+    result.primitiveGateCount = hierarchyGateCount(*config);
+    std::vector<Request> buffer(STREAM_BATCH);
+    visit_policy(static_cast<ReplacementPolicy>(config->policy), [&](auto type)
+    {
+        using Policy = typename decltype(type)::type;
+        replay<Policy>(*config, [&](Request*& batch)
+        {
+            batch = buffer.data();
+            return source(context, buffer.data(), buffer.size());
+        }, result);
+    });
+    return result;
+}
@@ -0,0 +1,19 @@
+#ifndef FASTSIMULATION_H
+#define FASTSIMULATION_H
+
+#include <cstddef>
+
+#include "simulation.h"
+
+/**
+ * Function prototype of the fast engine, replaying the requests through the cache hierarchy in a plain loop.
+ * It computes the same Result as the SystemC model without signals, clocks or events, the SystemC model stays the
+ * reference.
+ * @param config
+ * @param num_Requests
+ * @param requests read requests receive the data read, like in the SystemC model
+ * @return Result
+ */
+Result run_fast_simulation(const SimulationConfig& config, size_t num_Requests, Request* requests);
+
+#endif //FASTSIMULATION_H
@@ -1,8 +1,9 @@
 #ifndef MEMORY_H
 #define MEMORY_H
-#include <map>
 #include <systemc>
 
+#include "pagedMemory.h"
+
 using namespace sc_core;
 
 /**
@@ -23,41 +24,26 @@ public:
     /**
      * Constructor of the Module
      * @param name
+     * @param mmapBacked keep the contents in one anonymous mapping of the whole address space
      */
-    Memory(sc_module_name name) : sc_module(name)
+    Memory(sc_module_name name, const bool mmapBacked = false) : sc_module(name), memory(mmapBacked)
     {
-        // Defining the process of the Module
-        SC_THREAD(process);
+        // Defining the process of the Module, it runs again whenever one of the inputs changes
+        SC_METHOD(process);
         sensitive << clk.pos() << we << addr << wdata;
-
-        initialize();
-    }
-
-    // Clean up the memory
-    void initialize()
-    {
-        memory.clear();
     }
 
 private:
-    std::map<uint32_t, uint32_t> memory; ///< Memory Map (Address, Data)
+    PagedMemory memory; ///< Contents of the memory, addresses that were never written read as 0
 
     void write(const uint32_t addr, const uint32_t data) ///< Write to the Memory
     {
-        memory[addr] = data;
+        memory.write(addr, data);
     }
 
     void read(const uint32_t addr) ///< Read from the Memory
     {
-        const auto it = memory.find(addr); ///< Find the address in the memory
-        if (it != memory.end()) ///< If found
-        {
-            rdata.write(it->second); ///< Write the data to the read data signal
-        }
-        else
-        {
-            rdata.write(0); ///< Else write 0
-        }
+        rdata.write(memory.read(addr)); ///< Write the data to the read data signal
     }
 
     void process() ///< Process the memory requests
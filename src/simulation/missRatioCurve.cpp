@@ -0,0 +1,163 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * Binary indexed tree over the request times, holding a 1 at the time of each block's latest access.
+     * The number of distinct blocks touched between two times is a difference of two prefix sums.
+     */
+    class FenwickTree
+    {
+    public:
+        explicit FenwickTree(const size_t size) : tree(size + 1, 0)
+        {
+        }
+
+        void add(size_t index, const int32_t delta)
+        {
+            for (++index; index < tree.size(); index += index & (~index + 1))
+            {
+                tree[index] += delta;
+            }
+        }
+
+        /**
+         * @param end
+         * @return sum of the entries before end
+         */
+        uint32_t prefix(size_t end) const
+        {
+            uint32_t sum = 0;
+            for (; end > 0; end -= end & (~end + 1))
+            {
+                sum += tree[end];
+            }
+            return sum;
+        }
+
+    private:
+        std::vector<uint32_t> tree; ///< 1-based partial sums
+    };
+
+    /**
+     * Access history of one block
+     */
+    struct BlockHistory
+    {
+        size_t last; ///< Time of the latest access
+        std::vector<std::pair<size_t, size_t>> maxima; ///< (time, stack distance) with decreasing distances
+    };
+}
+
+/**
+ * Computes the miss-ratio curve of a fully associative LRU cache in one pass (Mattson's stack algorithm).
+ * A block survives between two of its accesses in a cache of C lines exactly if at most C - 1 other blocks were
+ * touched in between (stack distance <= C). As every word has its own valid bit, a request hits if its block
+ * survived every gap since the word was last accessed, so its hit distance is the largest stack distance of its
+ * block since then. Every access moves the block to the most recently used position, reads and writes alike.
+ * Writes are written through and allocate, reads pay the memory latency on a miss, like in Cache. A point whose
+ * requests run out of the cycle limit reports SIZE_MAX cycles, as the simulation does.
+ * @param config
+ * @param num_Requests
+ * @param requests
+ * @param points
+ */
+void run_miss_ratio_curve(
+    const struct SimulationConfig* config,
+    const size_t num_Requests,
+    const struct Request* requests,
+    struct MissRatioPoint* points)
+{
+    const CacheLevelConfig& level = config->levels[0];
+    const unsigned offset_bits = log2(level.cacheLineSize);
+    const unsigned max_lines = level.cacheLines;
+
+    FenwickTree latest(num_Requests);
+    std::unordered_map<uint32_t, BlockHistory> blocks; ///< Block address -> history
+    std::unordered_map<uint32_t, size_t> words; ///< Word address -> time of its latest access
+    std::vector<size_t> read_hits(max_lines + 1, 0); ///< Read hits by hit distance
+    std::vector<size_t> write_hits(max_lines + 1, 0); ///< Write hits by hit distance
+    size_t reads = 0;
+    size_t last_distance = SIZE_MAX; ///< Hit distance of the last request, SIZE_MAX if it misses in every size
+
+    for (size_t time = 0; time < num_Requests; ++time)
+    {
+        const Request& request = requests[time];
+        reads += !request.we;
+        last_distance = SIZE_MAX;
+
+        const auto block = blocks.find(request.addr >> offset_bits);
+        const auto word = words.find(request.addr);
+        if (block == blocks.end()) ///< Cold block, misses in every cache size
+        {
+            blocks.emplace(request.addr >> offset_bits, BlockHistory{time, {}});
+        }
+        else
+        {
+            BlockHistory& history = block->second;
+            const size_t distance = latest.prefix(time) - latest.prefix(history.last + 1) + 1;
+            latest.add(history.last, -1);
+            history.last = time;
+            while (!history.maxima.empty() && history.maxima.back().second <= distance)
+            {
+                history.maxima.pop_back();
+            }
+            history.maxima.emplace_back(time, distance);
+
+            if (word != words.end())
+            {
+                // Largest stack distance since the word was last accessed, the newest entry is always later
+                const auto since = std::upper_bound(history.maxima.begin(), history.maxima.end(),
+                                                    std::make_pair(word->second, SIZE_MAX));
+                if (since->second <= max_lines)
+                {
+                    (request.we ? write_hits : read_hits)[since->second]++;
+                }
+                last_distance = since->second;
+            }
+        }
+        latest.add(time, 1);
+        if (word != words.end())
+        {
+            word->second = time;
+        }
+        else
+        {
+            words.emplace(request.addr, time);
+        }
+    }
+
+    const size_t writes = num_Requests - reads;
+    size_t hits = 0;
+    size_t read_hit_count = 0;
+    for (unsigned lines = 1; lines <= max_lines; ++lines)
+    {
+        hits += read_hits[lines] + write_hits[lines];
+        read_hit_count += read_hits[lines];
+
+        MissRatioPoint& point = points[lines - 1];
+        point.cacheLines = lines;
+        point.hits = hits;
+        point.misses = num_Requests - hits;
+        point.cycles = num_Requests * static_cast<size_t>(level.latency) +
+                       (reads - read_hit_count + writes) * static_cast<size_t>(config->memoryLatency);
+
+        // Like the simulation, the run is out of cycles if the limit is reached before the last request
+        if (num_Requests > 1)
+        {
+            const bool last_paid_memory = requests[num_Requests - 1].we || last_distance > lines;
+            const size_t last_cycles = level.latency + (last_paid_memory ? config->memoryLatency : 0);
+            if (point.cycles - last_cycles >= static_cast<size_t>(config->cycles))
+            {
+                point.cycles = SIZE_MAX;
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "multicoreSimulation.h"
+
+#include <cstdint>
+
+#include "coherence.h"
+#include "pagedMemory.h"
+#include "primitiveGateCountCalc.h"
+#include "statisticsCollector.h"
+
+namespace
+{
+    /**
+     * Replay the requests through the coherent caches of one replacement policy
+     * @tparam Policy replacement policy, see replacementPolicy.h
+     * @param config
+     * @param num_requests
+     * @param requests
+     * @param result receives cycles, hits, misses and the coherence statistics
+     */
+    template <class Policy>
+    void replay(const SimulationConfig& config, const size_t num_requests, Request* requests, Result& result)
+    {
+        PagedMemory memory(config.mmapMemory != 0); ///< Words written to memory, the rest reads as 0
+        CoherentCaches<Policy> caches(config, memory);
+        StatisticsCollector statistics(config);
+        const size_t cycles_max = static_cast<size_t>(config.cycles);
+
+        size_t request_counter = 0;
+        while (request_counter < num_requests)
+        {
+            Request& request = requests[request_counter];
+            CoreAccess access{};
+            uint32_t data = 0;
+            if (request.we)
+            {
+                access = caches.write(request.core, request.addr, request.data);
+            }
+            else
+            {
+                access = caches.read(request.core, request.addr, data);
+                if (!config.discardReadData)
+                {
+                    request.data = data;
+                }
+            }
+            statistics.record(request.addr, request.we, access.hit, access.cycles);
+            if (access.hit)
+            {
+                result.hits++;
+            }
+            else
+            {
+                result.misses++;
+            }
+            request_counter++;
+
+            if (request_counter < num_requests && caches.cycles() >= cycles_max) ///< Out of cycles before the last
+            {
+                break;
+            }
+        }
+        result.cycles = request_counter < num_requests ? SIZE_MAX : caches.cycles();
+        caches.report(result);
+        statistics.report(result);
+    }
+}
+
+/**
+ * Runs the multi-core engine
+ * @param config
+ * @param num_Requests
+ * @param requests
+ * @return Result
+ */
+Result run_multicore_simulation(const SimulationConfig& config, const size_t num_Requests, Request* requests)
+{
+    Result result{};
+    result.primitiveGateCount = hierarchyGateCount(config);
+    visit_policy(static_cast<ReplacementPolicy>(config.policy), [&](auto type)
+    {
+        using Policy = typename decltype(type)::type;
+        replay<Policy>(config, num_Requests, requests, result);
+    });
+    return result;
+}
@@ -0,0 +1,19 @@
+#ifndef MULTICORESIMULATION_H
+#define MULTICORESIMULATION_H
+
+#include <cstddef>
+
+#include "simulation.h"
+
+/**
+ * Function prototype of the multi-core engine, replaying the requests of several cores in trace order through their
+ * private L1 caches, kept coherent over a bus or a directory. It is the functional model of the fast engine extended
+ * to config.cores caches, the pin-level and TLM models have a single core.
+ * @param config
+ * @param num_Requests
+ * @param requests read requests receive the data read, Request::core selects the core
+ * @return Result
+ */
+Result run_multicore_simulation(const SimulationConfig& config, size_t num_Requests, Request* requests);
+
+#endif //MULTICORESIMULATION_H
@@ -0,0 +1,86 @@
+#ifndef PAGEDMEMORY_H
+#define PAGEDMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/mman.h>
+#include <vector>
+
+/**
+ * Contents of the simulated memory, one data word per address.
+ * A two-level page table splits the 32 bit address into a page number and an offset, pages are allocated (zeroed)
+ * when they are written for the first time and addresses on pages that were never written read as 0.
+ * Alternatively the whole address space is reserved as one anonymous mapping, the operating system then allocates
+ * zeroed pages on first touch and an access needs no table lookup at all.
+ */
+class PagedMemory
+{
+public:
+    /**
+     * Constructor of the Memory
+     * @param mmapBacked reserve the whole address space as one anonymous mapping, falls back to the page table if
+     *        the mapping cannot be created
+     */
+    explicit PagedMemory(const bool mmapBacked = false)
+    {
+        if (mmapBacked)
+        {
+            void* const mapping = mmap(nullptr, FLAT_BYTES, PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (mapping != MAP_FAILED)
+            {
+                flat = static_cast<uint32_t*>(mapping);
+                return;
+            }
+        }
+        pages.resize(PAGES);
+    }
+
+    ~PagedMemory()
+    {
+        if (flat)
+        {
+            munmap(flat, FLAT_BYTES);
+        }
+    }
+
+    PagedMemory(const PagedMemory&) = delete;
+    PagedMemory& operator=(const PagedMemory&) = delete;
+
+    uint32_t read(const uint32_t addr) const
+    {
+        if (flat)
+        {
+            return flat[addr];
+        }
+        const std::unique_ptr<uint32_t[]>& page = pages[addr >> PAGE_BITS];
+        return page ? page[addr & (PAGE_WORDS - 1)] : 0;
+    }
+
+    void write(const uint32_t addr, const uint32_t data)
+    {
+        if (flat)
+        {
+            flat[addr] = data;
+            return;
+        }
+        std::unique_ptr<uint32_t[]>& page = pages[addr >> PAGE_BITS];
+        if (!page)
+        {
+            page.reset(new uint32_t[PAGE_WORDS]());
+        }
+        page[addr & (PAGE_WORDS - 1)] = data;
+    }
+
+private:
+    static constexpr unsigned PAGE_BITS = 16; ///< Address bits selecting the word within a page
+    static constexpr size_t PAGE_WORDS = size_t{1} << PAGE_BITS; ///< Data words per page (256 KiB)
+    static constexpr size_t PAGES = size_t{1} << (32 - PAGE_BITS); ///< Entries of the page table
+    static constexpr size_t FLAT_BYTES = (size_t{1} << 32) * sizeof(uint32_t); ///< Size of the flat mapping
+
+    std::vector<std::unique_ptr<uint32_t[]>> pages; ///< Page table, null for pages that were never written
+    uint32_t* flat = nullptr; ///< Flat mapping of the whole address space, null if the page table is used
+};
+
+#endif //PAGEDMEMORY_H
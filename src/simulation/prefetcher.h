@@ -0,0 +1,261 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "simulation.h"
+
+/**
+ * Hardware prefetchers attached to L1.
+ *
+ * A prefetcher watches the demand accesses to L1 and names the L1 blocks worth fetching ahead of time. It holds no
+ * notion of the cache contents or of time: the hierarchy drops the blocks that are already cached or on their way,
+ * fetches the rest from memory and keeps the statistics.
+ */
+class Prefetcher
+{
+public:
+    virtual ~Prefetcher() = default;
+
+    /**
+     * Observe a demand access to L1
+     * @param addr
+     * @param trigger whether the access missed in L1 or was the first to use a prefetched block
+     * @param blocks receives the base addresses of the blocks to prefetch
+     */
+    virtual void observe(uint32_t addr, bool trigger, std::vector<uint32_t>& blocks) = 0;
+
+protected:
+    /**
+     * @param blockSize L1 cache line size
+     */
+    explicit Prefetcher(const unsigned blockSize) :
+        BLOCK_SIZE(blockSize)
+    {
+    }
+
+    const unsigned BLOCK_SIZE; ///< Size of an L1 block
+
+    uint32_t block_of(const uint32_t addr) const { return addr & ~(BLOCK_SIZE - 1); }
+};
+
+/**
+ * Next-N-line: every trigger fetches the N blocks following the accessed one
+ */
+class NextLinePrefetcher final : public Prefetcher
+{
+public:
+    /**
+     * @param blockSize L1 cache line size
+     * @param degree number of blocks fetched per trigger
+     */
+    NextLinePrefetcher(const unsigned blockSize, const unsigned degree) :
+        Prefetcher(blockSize),
+        DEGREE(degree)
+    {
+    }
+
+    void observe(const uint32_t addr, const bool trigger, std::vector<uint32_t>& blocks) override
+    {
+        if (!trigger)
+        {
+            return;
+        }
+        for (unsigned i = 1; i <= DEGREE; ++i)
+        {
+            blocks.push_back(block_of(addr) + i * BLOCK_SIZE);
+        }
+    }
+
+private:
+    const unsigned DEGREE; ///< Blocks fetched per trigger
+};
+
+/**
+ * Stride table: the trace carries no program counter, so the table is indexed by the 4 KiB region of the address
+ * instead. Every access trains the entry of its region, once the same stride was seen twice in a row the next
+ * DEGREE strides ahead are fetched. Strides within a block fetch the next blocks in their direction.
+ */
+class StridePrefetcher final : public Prefetcher
+{
+public:
+    /**
+     * @param blockSize L1 cache line size
+     * @param degree strides fetched ahead
+     * @param entries entries of the stride table
+     */
+    StridePrefetcher(const unsigned blockSize, const unsigned degree, const unsigned entries) :
+        Prefetcher(blockSize),
+        DEGREE(degree),
+        table(entries, Entry{})
+    {
+    }
+
+    void observe(const uint32_t addr, bool, std::vector<uint32_t>& blocks) override
+    {
+        const uint32_t region = addr >> REGION_BITS;
+        Entry& entry = table[region % table.size()];
+        if (!entry.valid || entry.region != region)
+        {
+            entry = Entry{true, region, addr, 0, 0};
+            return;
+        }
+        const int64_t stride = static_cast<int64_t>(addr) - entry.last;
+        if (stride == 0)
+        {
+            return;
+        }
+        if (stride == entry.stride)
+        {
+            entry.confidence += entry.confidence < MAX_CONFIDENCE;
+        }
+        else
+        {
+            entry.stride = stride;
+            entry.confidence = 0;
+        }
+        entry.last = addr;
+        if (entry.confidence < THRESHOLD)
+        {
+            return;
+        }
+
+        const int64_t block_size = BLOCK_SIZE;
+        const int64_t step = stride > -block_size && stride < block_size ? (stride > 0 ? block_size : -block_size)
+                                                                         : stride;
+        int64_t target = addr;
+        for (unsigned i = 0; i < DEGREE; ++i)
+        {
+            target += step;
+            if (target < 0 || target > UINT32_MAX)
+            {
+                return;
+            }
+            blocks.push_back(block_of(static_cast<uint32_t>(target)));
+        }
+    }
+
+private:
+    static constexpr unsigned REGION_BITS = 12; ///< Size of the regions sharing an entry (4 KiB)
+    static constexpr unsigned THRESHOLD = 1; ///< Repeats of a stride before it is prefetched
+    static constexpr unsigned MAX_CONFIDENCE = 3; ///< Saturation of the 2 bit confidence counter
+
+    /**
+     * Entry of the stride table
+     */
+    struct Entry
+    {
+        bool valid; ///< Whether the entry was trained
+        uint32_t region; ///< Region the entry belongs to
+        uint32_t last; ///< Last address accessed in the region
+        int64_t stride; ///< Last stride seen in the region
+        unsigned confidence; ///< How often the stride repeated
+    };
+
+    const unsigned DEGREE; ///< Strides fetched ahead
+    std::vector<Entry> table; ///< Stride table, indexed by region
+};
+
+/**
+ * Stream buffers: a miss outside every stream starts a new one in the least recently used buffer, which runs DEPTH
+ * blocks ahead of it. A trigger inside a stream consumes the stream up to it and tops the buffer up again. The
+ * buffers hand their blocks straight to L1 instead of holding them until they are hit.
+ */
+class StreamPrefetcher final : public Prefetcher
+{
+public:
+    /**
+     * @param blockSize L1 cache line size
+     * @param depth blocks each stream runs ahead
+     * @param streams number of stream buffers
+     */
+    StreamPrefetcher(const unsigned blockSize, const unsigned depth, const unsigned streams) :
+        Prefetcher(blockSize),
+        DEPTH(depth),
+        buffers(streams, Stream{})
+    {
+    }
+
+    void observe(const uint32_t addr, const bool trigger, std::vector<uint32_t>& blocks) override
+    {
+        if (!trigger)
+        {
+            return;
+        }
+        const uint64_t block = block_of(addr);
+        Stream* stream = nullptr;
+        for (Stream& candidate : buffers)
+        {
+            if (candidate.valid && block >= candidate.head - BLOCK_SIZE && block < candidate.tail)
+            {
+                stream = &candidate;
+                break;
+            }
+        }
+        if (!stream) ///< Replace the least recently used stream
+        {
+            stream = &buffers[0];
+            for (Stream& candidate : buffers)
+            {
+                if (!candidate.valid || candidate.used < stream->used)
+                {
+                    stream = &candidate;
+                }
+            }
+            stream->valid = true;
+            stream->tail = block + BLOCK_SIZE;
+        }
+        stream->head = block + BLOCK_SIZE;
+        stream->used = ++accesses;
+        while (stream->tail < stream->head + static_cast<uint64_t>(DEPTH) * BLOCK_SIZE && stream->tail <= UINT32_MAX)
+        {
+            blocks.push_back(static_cast<uint32_t>(stream->tail));
+            stream->tail += BLOCK_SIZE;
+        }
+    }
+
+private:
+    /**
+     * State of one stream buffer
+     */
+    struct Stream
+    {
+        bool valid; ///< Whether the buffer follows a stream
+        uint64_t head; ///< Next block the stream is expected to use
+        uint64_t tail; ///< Next block to fetch
+        size_t used; ///< When the stream was last used
+    };
+
+    const unsigned DEPTH; ///< Blocks each stream runs ahead
+    std::vector<Stream> buffers; ///< Stream buffers
+    size_t accesses = 0; ///< Triggers seen, orders the streams by use
+};
+
+/**
+ * Create the configured L1 prefetcher
+ * @param config
+ * @return prefetcher or null if prefetching is off
+ */
+inline std::unique_ptr<Prefetcher> create_prefetcher(const SimulationConfig& config)
+{
+    const unsigned block_size = config.levels[0].cacheLineSize;
+    switch (config.prefetcher)
+    {
+    case PREFETCH_NEXT_LINE:
+        return std::unique_ptr<Prefetcher>(new NextLinePrefetcher(block_size, config.prefetchDegree));
+    case PREFETCH_STRIDE:
+        return std::unique_ptr<Prefetcher>(new StridePrefetcher(block_size, config.prefetchDegree,
+                                                                config.prefetchEntries));
+    case PREFETCH_STREAM:
+        return std::unique_ptr<Prefetcher>(new StreamPrefetcher(block_size, config.prefetchDegree,
+                                                                config.prefetchEntries));
+    case PREFETCH_NONE:
+    default:
+        return nullptr;
+    }
+}
+
+#endif //PREFETCHER_H
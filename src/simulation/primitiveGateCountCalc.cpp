@@ -1,5 +1,6 @@
 #include "primitiveGateCountCalc.h"
 
+#include <cmath>
 #include <cstddef>
 
 /**
@@ -8,36 +9,83 @@
  * @param CacheLineSize
  * @param tagBits
  * @param indexBits
- * @param directMapped
+ * @param ways
+ * @param policy
  * @return Number of primitive gates
  * @remark The calculation for the number of primitive gates is based on the following assumptions:
  *  - The cache is implemented using a 6T SRAM cell
  *  - Transistors are considered to be primitive gates
  *  - "More than Two-Inputs" gates are assumed to be still primitive gates
+ *  - An N-way cache selects the set with one tag multiplexer per way, compares the N tags in parallel and keeps one
+ *    LRU unit per set, so direct mapped (1 way) and fully associative (cacheLines ways) come out as before
  */
 size_t primitiveGateCount(unsigned const cacheLines, unsigned const CacheLineSize, unsigned const tagBits,
                           unsigned const indexBits,
-                          bool const directMapped)
+                          unsigned const ways, ReplacementPolicy const policy)
 {
+    unsigned const sets = cacheLines / ways;
+
     // Calculate the number of gates required to realize a multiplexer, comparator, and storage cells
-    unsigned const muxGateCount = tagBits * ::muxGateCount(cacheLines, indexBits);
-    unsigned const comparatorGateCount = directMapped
-                                             ? ::comparatorGateCount(tagBits)
-                                             : ::comparatorGateCount(tagBits) * cacheLines;
-    unsigned const storageGateCount = ::storageGateCount(CacheLineSize, cacheLines, tagBits);
-    unsigned const lruGateCount = ::lruGateCount(cacheLines, tagBits);
+    size_t const muxGateCount = sets > 1 ? static_cast<size_t>(ways) * tagBits * ::muxGateCount(sets, indexBits) : 0;
+    size_t const comparatorGateCount = static_cast<size_t>(ways) * ::comparatorGateCount(tagBits);
+    size_t const storageGateCount = ::storageGateCount(CacheLineSize, cacheLines, tagBits);
 
     // If direct mapped, we need the mux, comparator, and storage gates
-    if (directMapped)
+    if (ways == 1)
     {
         return muxGateCount + comparatorGateCount + storageGateCount;
     }
 
+    // Replacement logic
+    size_t const replacementGateCount = ::replacementGateCount(policy, sets, ways, tagBits);
+
     // Total number of primitive gates
-    return comparatorGateCount + storageGateCount + 1 + lruGateCount;
+    return muxGateCount + comparatorGateCount + storageGateCount + 1 + replacementGateCount;
     ///< One OR gate (N-Inputs) using the comparator outputs
 }
 
+/**
+ * Function to calculate the number of primitive gates required to implement all levels of a cache hierarchy, the
+ * MSHRs of a non-blocking L1, its prefetcher and its victim cache, once per core of a multi-core run
+ * @param config
+ * @return Number of primitive gates
+ */
+size_t hierarchyGateCount(SimulationConfig const& config)
+{
+    size_t total = 0;
+    for (unsigned i = 0; i < config.numLevels; ++i)
+    {
+        CacheLevelConfig const& level = config.levels[i];
+        unsigned const offsetBits = log2(level.cacheLineSize);
+        unsigned const indexBits = log2(level.cacheLines / level.ways);
+        unsigned const tagBits = 32 - offsetBits - indexBits;
+        total += ::primitiveGateCount(level.cacheLines, level.cacheLineSize, tagBits, indexBits, level.ways,
+                                      static_cast<ReplacementPolicy>(config.policy));
+    }
+    if (config.mshrs != 0)
+    {
+        // Every MSHR holds a block address with a valid bit and compares it against the missing block
+        unsigned const blockBits = 32 - log2(config.levels[0].cacheLineSize);
+        total += static_cast<size_t>(config.mshrs) * (::storageGateCount(0, 1, blockBits) +
+                                                      ::comparatorGateCount(blockBits));
+    }
+    total += ::prefetcherGateCount(static_cast<PrefetcherKind>(config.prefetcher), config.prefetchEntries,
+                                   32 - log2(config.levels[0].cacheLineSize));
+    if (config.victimEntries != 0)
+    {
+        // A fully associative LRU cache with L1's block size
+        unsigned const blockBits = 32 - log2(config.levels[0].cacheLineSize);
+        total += ::primitiveGateCount(config.victimEntries, config.levels[0].cacheLineSize, blockBits, 0,
+                                      config.victimEntries, POLICY_LRU);
+    }
+    if (config.cores > 1)
+    {
+        // Valid and dirty bit encode MSI, every line needs one more state bit to tell E (and O) apart
+        total = config.cores * (total + ::storageGateCount(0, config.levels[0].cacheLines, 0));
+    }
+    return total;
+}
+
 /**
  * A helper function to calculate the number of primitive gates required to implement a multiplexer
  * @param cacheLines
@@ -100,3 +148,89 @@ unsigned lruGateCount(unsigned const cacheLines, unsigned const tagBits)
 
     return comparatorGateCount + lruLogicGateCount;
 }
+
+/**
+ * A helper function to calculate the number of primitive gates required to implement the replacement policy
+ * @param policy
+ * @param sets
+ * @param ways
+ * @param tagBits
+ * @return Number of primitive gates
+ * @remark State bits are counted as 6T SRAM cells like the storage, the update logic is a simplification
+ */
+size_t replacementGateCount(ReplacementPolicy const policy, unsigned const sets, unsigned const ways,
+                            unsigned const tagBits)
+{
+    unsigned constexpr transistors_per_bit = 6;
+    unsigned const wayBits = log2(ways);
+    size_t perSet = 0;
+
+    switch (policy)
+    {
+    case POLICY_FIFO:
+        // Round robin pointer with an incrementer (XOR and AND per bit)
+        perSet = wayBits * transistors_per_bit + wayBits * 2;
+        break;
+    case POLICY_RANDOM:
+        // One shared 16 bit LFSR with its feedback XORs, no per set state
+        return 16 * transistors_per_bit + 3;
+    case POLICY_PLRU:
+        // One bit per inner tree node, each with a set/reset gate pair and a victim path AND
+        perSet = static_cast<size_t>(ways - 1) * (transistors_per_bit + 3);
+        break;
+    case POLICY_SRRIP:
+    case POLICY_BRRIP:
+        // 2 bits per way, a saturating incrementer (3 gates) and a "== 3" detector (1 AND) per way
+        perSet = static_cast<size_t>(ways) * (2 * transistors_per_bit + 4);
+        if (policy == POLICY_BRRIP)
+        {
+            // One shared 5 bit throttle counter
+            return sets * perSet + 5 * transistors_per_bit + 5 * 2;
+        }
+        break;
+    case POLICY_LFU:
+        // 8 bit counter with incrementer per way and a comparator tree to find the minimum
+        perSet = static_cast<size_t>(ways) * (8 * transistors_per_bit + 8 * 2)
+            + static_cast<size_t>(ways - 1) * ::comparatorGateCount(8);
+        break;
+    case POLICY_LRU:
+    default:
+        perSet = ::lruGateCount(ways, tagBits);
+        break;
+    }
+
+    return sets * perSet;
+}
+
+/**
+ * A helper function to calculate the number of primitive gates required to implement an L1 prefetcher
+ * @param prefetcher
+ * @param entries entries of the stride table or number of stream buffers
+ * @param blockBits bits of a block address
+ * @return Number of primitive gates
+ * @remark Every adder bit is counted as a full adder of 5 gates, the tables are 6T SRAM cells like the cache:
+ *  - next-line: one adder producing the next block address
+ *  - stride: per entry a region tag, the last address, the stride, a 2 bit confidence and a valid bit, plus the tag
+ *    comparator of the indexed entry, a subtractor for the new stride and an adder for the target
+ *  - stream: per buffer the head and tail block addresses and a valid bit, two comparators checking whether a block
+ *    falls into the stream and an adder advancing the tail
+ */
+size_t prefetcherGateCount(PrefetcherKind const prefetcher, unsigned const entries, unsigned const blockBits)
+{
+    unsigned constexpr adder_gates_per_bit = 5;
+    unsigned constexpr region_bits = 20; ///< 4 KiB regions of a 32 bit address
+    switch (prefetcher)
+    {
+    case PREFETCH_NEXT_LINE:
+        return blockBits * adder_gates_per_bit;
+    case PREFETCH_STRIDE:
+        return ::storageGateCount(0, entries, region_bits + 32 + 32 + 2) + ::comparatorGateCount(region_bits) +
+               2 * 32 * adder_gates_per_bit;
+    case PREFETCH_STREAM:
+        return ::storageGateCount(0, entries, 2 * blockBits) +
+               static_cast<size_t>(entries) * 2 * ::comparatorGateCount(blockBits) + blockBits * adder_gates_per_bit;
+    case PREFETCH_NONE:
+    default:
+        return 0;
+    }
+}
@@ -3,17 +3,27 @@
 
 #include <cstddef>
 
+#include "simulation.h"
+
 /**
  * Function prototype to calculate the number of primitive gates required to implement the cache
  * @param cacheLines
  * @param CacheLineSize
  * @param tagBits
  * @param indexBits
- * @param directMapped
+ * @param ways
+ * @param policy
  * @return Number of primitive gates
  */
 size_t primitiveGateCount(unsigned cacheLines, unsigned CacheLineSize, unsigned tagBits, unsigned indexBits,
-                          bool directMapped);
+                          unsigned ways, ReplacementPolicy policy);
+
+/**
+ * Function prototype to calculate the number of primitive gates required to implement all levels of a cache hierarchy
+ * @param config
+ * @return Number of primitive gates
+ */
+size_t hierarchyGateCount(SimulationConfig const& config);
 
 /**
  * A helper function prototype to calculate the number of primitive gates required to implement a multiplexer
@@ -47,5 +57,24 @@ unsigned storageGateCount(unsigned CacheLineSize, unsigned cacheLines, unsigned
  */
 unsigned lruGateCount(unsigned const cacheLines, unsigned const tagBits);
 
+/**
+ * A helper function prototype to calculate the number of primitive gates required to implement the replacement policy
+ * @param policy
+ * @param sets
+ * @param ways
+ * @param tagBits
+ * @return Number of primitive gates
+ */
+size_t replacementGateCount(ReplacementPolicy policy, unsigned sets, unsigned ways, unsigned tagBits);
+
+/**
+ * A helper function prototype to calculate the number of primitive gates required to implement an L1 prefetcher
+ * @param prefetcher
+ * @param entries
+ * @param blockBits
+ * @return Number of primitive gates
+ */
+size_t prefetcherGateCount(PrefetcherKind prefetcher, unsigned entries, unsigned blockBits);
+
 
 #endif //PRIMITIVEGATECOUNTCALC_H
@@ -0,0 +1,451 @@
+#ifndef REPLACEMENTPOLICY_H
+#define REPLACEMENTPOLICY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "simulation.h"
+
+/**
+ * Replacement policies of the CacheEngine.
+ *
+ * A policy is a template parameter of the engine, so every call below is resolved at compile time. Each policy
+ * provides the same interface, with ways counted from 0 inside a set:
+ *  - Policy(sets, ways)
+ *  - void on_hit(set, way)         the line was referenced again
+ *  - void on_fill(set, way)        a new block was placed in the line
+ *  - void on_invalidate(set, way)  the line no longer holds a block
+ *  - unsigned victim(set)          the way to replace, only asked for when every way of the set holds a block
+ */
+
+constexpr unsigned LIST_NIL = ~0u; ///< End marker of the intrusive lists below
+
+/**
+ * Intrusive doubly linked list per set over the lines of the cache, shared by LRU and FIFO.
+ * The front is the next victim, the back the most recently inserted or touched line. All operations are O(1).
+ */
+class RecencyList
+{
+public:
+    RecencyList(const unsigned sets, const unsigned ways) :
+        WAYS(ways),
+        prev(static_cast<size_t>(sets) * ways),
+        next(static_cast<size_t>(sets) * ways),
+        head(sets),
+        tail(sets)
+    {
+        // Every set starts with its ways in ascending order, way 0 at the front
+        for (unsigned set = 0; set < sets; ++set)
+        {
+            const unsigned first = set * WAYS;
+            for (unsigned way = 0; way < WAYS; ++way)
+            {
+                prev[first + way] = way == 0 ? LIST_NIL : first + way - 1;
+                next[first + way] = way + 1 == WAYS ? LIST_NIL : first + way + 1;
+            }
+            head[set] = first;
+            tail[set] = first + WAYS - 1;
+        }
+    }
+
+    /**
+     * Move a line to the back of its set's list
+     * @param set
+     * @param way
+     */
+    void move_to_back(const unsigned set, const unsigned way)
+    {
+        const unsigned line = set * WAYS + way;
+        if (line == tail[set])
+        {
+            return;
+        }
+        // Unlink the line from its current position, it has a successor because it is not the tail
+        if (prev[line] == LIST_NIL)
+        {
+            head[set] = next[line];
+        }
+        else
+        {
+            next[prev[line]] = next[line];
+        }
+        prev[next[line]] = prev[line];
+
+        // Append the line to the back of the list
+        prev[line] = tail[set];
+        next[line] = LIST_NIL;
+        next[tail[set]] = line;
+        tail[set] = line;
+    }
+
+    /**
+     * @param set
+     * @return way at the front of the set's list
+     */
+    unsigned front(const unsigned set) const
+    {
+        return head[set] - set * WAYS;
+    }
+
+private:
+    const unsigned WAYS; ///< Number of ways per set
+    std::vector<unsigned> prev; ///< Predecessor of each line
+    std::vector<unsigned> next; ///< Successor of each line
+    std::vector<unsigned> head; ///< Front of each set's list
+    std::vector<unsigned> tail; ///< Back of each set's list
+};
+
+/**
+ * Least Recently Used: hits and fills move the line to the back, the front is replaced
+ */
+class LruPolicy
+{
+public:
+    LruPolicy(const unsigned sets, const unsigned ways) : order(sets, ways)
+    {
+    }
+
+    void on_hit(const unsigned set, const unsigned way) { order.move_to_back(set, way); }
+    void on_fill(const unsigned set, const unsigned way) { order.move_to_back(set, way); }
+    void on_invalidate(unsigned, unsigned) {}
+    unsigned victim(const unsigned set) const { return order.front(set); }
+
+private:
+    RecencyList order; ///< Recency order per set
+};
+
+/**
+ * First In First Out: only fills move the line to the back, hits do not change the order
+ */
+class FifoPolicy
+{
+public:
+    FifoPolicy(const unsigned sets, const unsigned ways) : order(sets, ways)
+    {
+    }
+
+    void on_hit(unsigned, unsigned) {}
+    void on_fill(const unsigned set, const unsigned way) { order.move_to_back(set, way); }
+    void on_invalidate(unsigned, unsigned) {}
+    unsigned victim(const unsigned set) const { return order.front(set); }
+
+private:
+    RecencyList order; ///< Insertion order per set
+};
+
+/**
+ * Random replacement driven by a fixed-seed xorshift generator, so runs are reproducible
+ */
+class RandomPolicy
+{
+public:
+    RandomPolicy(unsigned, const unsigned ways) : WAYS(ways)
+    {
+    }
+
+    void on_hit(unsigned, unsigned) {}
+    void on_fill(unsigned, unsigned) {}
+    void on_invalidate(unsigned, unsigned) {}
+
+    unsigned victim(unsigned)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state % WAYS;
+    }
+
+private:
+    const unsigned WAYS; ///< Number of ways per set
+    uint32_t state = 0x2545F491u; ///< xorshift32 state
+};
+
+/**
+ * Tree pseudo-LRU: one bit per inner node of a binary tree over the ways of a set (ways must be a power of two).
+ * A bit of 0 sends the victim search left, 1 right. Every reference flips the bits on its path away from the line.
+ */
+class TreePlruPolicy
+{
+public:
+    TreePlruPolicy(const unsigned sets, const unsigned ways) :
+        WAYS(ways),
+        bits(static_cast<size_t>(sets) * ways, 0)
+    {
+    }
+
+    void on_hit(const unsigned set, const unsigned way) { point_away(set, way); }
+    void on_fill(const unsigned set, const unsigned way) { point_away(set, way); }
+    void on_invalidate(unsigned, unsigned) {}
+
+    unsigned victim(const unsigned set) const
+    {
+        const uint8_t* tree = &bits[static_cast<size_t>(set) * WAYS];
+        unsigned node = 1; ///< Root, the children of node n are 2n and 2n + 1, the leaves are WAYS..2 * WAYS - 1
+        while (node < WAYS)
+        {
+            node = 2 * node + tree[node];
+        }
+        return node - WAYS;
+    }
+
+private:
+    const unsigned WAYS; ///< Number of ways per set
+    std::vector<uint8_t> bits; ///< Tree bits of each set, index 0 of a set is unused
+
+    void point_away(const unsigned set, const unsigned way)
+    {
+        uint8_t* tree = &bits[static_cast<size_t>(set) * WAYS];
+        for (unsigned node = WAYS + way; node > 1; node /= 2)
+        {
+            tree[node / 2] = (node & 1) == 0; ///< Left child referenced, so point right and vice versa
+        }
+    }
+};
+
+/**
+ * Re-Reference Interval Prediction with 2-bit prediction values (RRPV), static (SRRIP) or bimodal (BRRIP) insertion.
+ * Hits predict a near re-reference (0), the victim is a line with a distant one (3). If the set has none, all values
+ * are aged until one has. Lines are kept in one list per value and aging only renames the lists, so each operation is
+ * O(1). Among the lines at 3 the one that got there first is replaced.
+ * @tparam BIMODAL insert at 3 and only every 32nd fill at 2 (BRRIP) instead of always at 2 (SRRIP)
+ */
+template <bool BIMODAL>
+class RripPolicy
+{
+public:
+    RripPolicy(const unsigned sets, const unsigned ways) :
+        WAYS(ways),
+        bucket(static_cast<size_t>(sets) * ways, UNLINKED),
+        prev(static_cast<size_t>(sets) * ways),
+        next(static_cast<size_t>(sets) * ways),
+        head(static_cast<size_t>(sets) * LEVELS, LIST_NIL),
+        tail(static_cast<size_t>(sets) * LEVELS, LIST_NIL),
+        shift(sets, 0)
+    {
+    }
+
+    void on_hit(const unsigned set, const unsigned way)
+    {
+        move(set, set * WAYS + way, 0);
+    }
+
+    void on_fill(const unsigned set, const unsigned way)
+    {
+        unsigned rrpv = RRPV_MAX - 1;
+        if (BIMODAL && throttle++ % BIMODAL_THROTTLE != 0)
+        {
+            rrpv = RRPV_MAX;
+        }
+        move(set, set * WAYS + way, rrpv);
+    }
+
+    void on_invalidate(const unsigned set, const unsigned way)
+    {
+        unlink(set, set * WAYS + way);
+    }
+
+    unsigned victim(const unsigned set)
+    {
+        // Age the set until the highest occupied prediction value is RRPV_MAX
+        for (unsigned rrpv = RRPV_MAX; rrpv != ~0u; --rrpv)
+        {
+            if (head[list_of(set, rrpv)] != LIST_NIL)
+            {
+                shift[set] = (shift[set] + RRPV_MAX - rrpv) % LEVELS;
+                break;
+            }
+        }
+        return head[list_of(set, RRPV_MAX)] - set * WAYS;
+    }
+
+private:
+    static constexpr unsigned RRPV_MAX = 3; ///< Distant re-reference
+    static constexpr unsigned LEVELS = RRPV_MAX + 1; ///< Number of prediction values
+    static constexpr unsigned BIMODAL_THROTTLE = 32; ///< BRRIP inserts one in this many fills at RRPV_MAX - 1
+    static constexpr uint8_t UNLINKED = 0xFF; ///< Bucket of a line holding no block
+
+    const unsigned WAYS; ///< Number of ways per set
+    std::vector<uint8_t> bucket; ///< Physical list of each line
+    std::vector<unsigned> prev; ///< Predecessor of each line in its list
+    std::vector<unsigned> next; ///< Successor of each line in its list
+    std::vector<unsigned> head; ///< Front of each (set, physical list)
+    std::vector<unsigned> tail; ///< Back of each (set, physical list)
+    std::vector<uint8_t> shift; ///< Per set aging, prediction value = (physical list + shift) % LEVELS
+    unsigned throttle = 0; ///< Fill counter for bimodal insertion
+
+    size_t list_of(const unsigned set, const unsigned rrpv) const
+    {
+        return static_cast<size_t>(set) * LEVELS + (rrpv + LEVELS - shift[set]) % LEVELS;
+    }
+
+    void unlink(const unsigned set, const unsigned line)
+    {
+        if (bucket[line] == UNLINKED)
+        {
+            return;
+        }
+        const size_t list = static_cast<size_t>(set) * LEVELS + bucket[line];
+        (prev[line] == LIST_NIL ? head[list] : next[prev[line]]) = next[line];
+        (next[line] == LIST_NIL ? tail[list] : prev[next[line]]) = prev[line];
+        bucket[line] = UNLINKED;
+    }
+
+    void move(const unsigned set, const unsigned line, const unsigned rrpv)
+    {
+        unlink(set, line);
+        const size_t list = list_of(set, rrpv);
+        bucket[line] = static_cast<uint8_t>(list % LEVELS);
+        prev[line] = tail[list];
+        next[line] = LIST_NIL;
+        (tail[list] == LIST_NIL ? head[list] : next[tail[list]]) = line;
+        tail[list] = line;
+    }
+};
+
+template <bool BIMODAL>
+constexpr unsigned RripPolicy<BIMODAL>::RRPV_MAX;
+template <bool BIMODAL>
+constexpr unsigned RripPolicy<BIMODAL>::LEVELS;
+template <bool BIMODAL>
+constexpr unsigned RripPolicy<BIMODAL>::BIMODAL_THROTTLE;
+template <bool BIMODAL>
+constexpr uint8_t RripPolicy<BIMODAL>::UNLINKED;
+
+using SrripPolicy = RripPolicy<false>;
+using BrripPolicy = RripPolicy<true>;
+
+/**
+ * Least Frequently Used with LRU tie breaking. Lines are kept in one list per (set, reference count), so hits,
+ * fills and victim selection are O(1).
+ */
+class LfuPolicy
+{
+public:
+    LfuPolicy(const unsigned sets, const unsigned ways) :
+        WAYS(ways),
+        count(static_cast<size_t>(sets) * ways, 0),
+        prev(static_cast<size_t>(sets) * ways),
+        next(static_cast<size_t>(sets) * ways),
+        min_count(sets, 1)
+    {
+    }
+
+    void on_hit(const unsigned set, const unsigned way)
+    {
+        const unsigned line = set * WAYS + way;
+        const uint32_t old_count = count[line];
+        if (unlink(set, line) && old_count == min_count[set])
+        {
+            min_count[set] = old_count + 1; ///< The least frequent list ran empty, the line is now the minimum
+        }
+        link(set, line, old_count + 1);
+    }
+
+    void on_fill(const unsigned set, const unsigned way)
+    {
+        const unsigned line = set * WAYS + way;
+        unlink(set, line);
+        link(set, line, 1);
+        min_count[set] = 1;
+    }
+
+    /**
+     * Drop the line from its list. The set's minimum may go stale, but the next victim is only asked for once the
+     * freed way has been filled again, which resets the minimum to 1.
+     */
+    void on_invalidate(const unsigned set, const unsigned way)
+    {
+        unlink(set, set * WAYS + way);
+    }
+
+    unsigned victim(const unsigned set) const
+    {
+        return lists.at(key(set, min_count[set])).first - set * WAYS;
+    }
+
+private:
+    const unsigned WAYS; ///< Number of ways per set
+    std::vector<uint32_t> count; ///< Reference count of each line, 0 if it holds no block
+    std::vector<unsigned> prev; ///< Predecessor of each line in its list
+    std::vector<unsigned> next; ///< Successor of each line in its list
+    std::vector<uint32_t> min_count; ///< Smallest reference count per set
+    std::unordered_map<uint64_t, std::pair<unsigned, unsigned>> lists; ///< (set, count) -> (front, back)
+
+    static uint64_t key(const unsigned set, const uint32_t refs)
+    {
+        return static_cast<uint64_t>(set) << 32 | refs;
+    }
+
+    /**
+     * @return true if the line's list ran empty
+     */
+    bool unlink(const unsigned set, const unsigned line)
+    {
+        if (count[line] == 0)
+        {
+            return false;
+        }
+        const auto it = lists.find(key(set, count[line]));
+        (prev[line] == LIST_NIL ? it->second.first : next[prev[line]]) = next[line];
+        (next[line] == LIST_NIL ? it->second.second : prev[next[line]]) = prev[line];
+        count[line] = 0;
+        if (it->second.first == LIST_NIL)
+        {
+            lists.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    void link(const unsigned set, const unsigned line, const uint32_t refs)
+    {
+        auto& list = lists.emplace(key(set, refs), std::make_pair(LIST_NIL, LIST_NIL)).first->second;
+        count[line] = refs;
+        prev[line] = list.second;
+        next[line] = LIST_NIL;
+        (list.second == LIST_NIL ? list.first : next[list.second]) = line;
+        list.second = line;
+    }
+};
+
+/**
+ * Type carrier for visit_policy
+ */
+template <class Policy>
+struct PolicyType
+{
+    using type = Policy;
+};
+
+/**
+ * Call a generic visitor with the policy class selected at runtime, so the code it instantiates is specialized on it
+ * @param policy
+ * @param visitor called as visitor(PolicyType<P>{})
+ * @return the visitor's result
+ */
+template <class Visitor>
+auto visit_policy(const enum ReplacementPolicy policy, Visitor&& visitor) -> decltype(visitor(PolicyType<LruPolicy>{}))
+{
+    switch (policy)
+    {
+    case POLICY_FIFO:
+        return visitor(PolicyType<FifoPolicy>{});
+    case POLICY_RANDOM:
+        return visitor(PolicyType<RandomPolicy>{});
+    case POLICY_PLRU:
+        return visitor(PolicyType<TreePlruPolicy>{});
+    case POLICY_SRRIP:
+        return visitor(PolicyType<SrripPolicy>{});
+    case POLICY_BRRIP:
+        return visitor(PolicyType<BrripPolicy>{});
+    case POLICY_LFU:
+        return visitor(PolicyType<LfuPolicy>{});
+    case POLICY_LRU:
+    default:
+        return visitor(PolicyType<LruPolicy>{});
+    }
+}
+
+#endif //REPLACEMENTPOLICY_H
@@ -1,5 +1,8 @@
 #include "simulation.h"
 #include "controller.h"
+#include "fastSimulation.h"
+#include "multicoreSimulation.h"
+#include "tlmController.h"
 
 #include <systemc>
 
@@ -9,6 +12,8 @@ using namespace sc_core;
  * Runs the SystemC Cache Simulation
  * @param cycles
  * @param directMapped
+ * @param ways associativity, 0 selects fully associative (ignored if directMapped is set)
+ * @param policy replacement policy (enum ReplacementPolicy)
  * @param cacheLines
  * @param CacheLineSize
  * @param cacheLatency
@@ -21,6 +26,8 @@ using namespace sc_core;
 struct Result run_simulation(
     int cycles,
     int directMapped,
+    unsigned ways,
+    int policy,
     unsigned cacheLines,
     unsigned CacheLineSize,
     unsigned cacheLatency,
@@ -31,6 +38,71 @@ struct Result run_simulation(
     // Die vorherige Schreibweise gehört nicht zum standard.
     const char* tracefile)
 {
+    // A single cache level, direct mapped and fully associative are the 1-way and all-ways special cases
+    SimulationConfig config{};
+    config.cycles = cycles;
+    config.engine = ENGINE_SYSTEMC;
+    config.memoryLatency = memoryLatency;
+    config.policy = policy;
+    config.inclusion = INCLUSION_INCLUSIVE;
+    config.writePolicy = WRITE_THROUGH;
+    config.writeAllocate = 1;
+    config.numLevels = 1;
+    config.levels[0].cacheLines = cacheLines;
+    config.levels[0].cacheLineSize = CacheLineSize;
+    config.levels[0].ways = directMapped ? 1 : (ways != 0 ? ways : cacheLines);
+    config.levels[0].latency = cacheLatency;
+
+    return run_simulation_with_config(&config, num_Requests, requests, tracefile);
+}
+
+/**
+ * Runs the TLM-2.0 loosely-timed model
+ * @param config
+ * @param num_Requests
+ * @param requests
+ * @return Result
+ */
+static Result run_tlm_simulation(const SimulationConfig& config, size_t num_Requests, Request* requests)
+{
+    TlmController controller("controller", config, requests, num_Requests);
+    Result result{};
+
+    // Runs until the controller stops the simulation, the cycle limit is checked by the controller
+    sc_start();
+
+    controller.report(result);
+    return result;
+}
+
+/**
+ * Runs the SystemC Cache Simulation for a cache hierarchy
+ * @param config
+ * @param num_Requests
+ * @param requests
+ * @param tracefile
+ * @return Result
+ */
+struct Result run_simulation_with_config(
+    const struct SimulationConfig* config,
+    size_t num_Requests,
+    struct Request* requests,
+    const char* tracefile)
+{
+    if (config->engine == ENGINE_FAST && config->cores > 1)
+    {
+        return run_multicore_simulation(*config, num_Requests, requests);
+    }
+    if (config->engine == ENGINE_FAST)
+    {
+        return run_fast_simulation(*config, num_Requests, requests);
+    }
+    if (config->engine == ENGINE_TLM)
+    {
+        return run_tlm_simulation(*config, num_Requests, requests);
+    }
+
+    const int cycles = config->cycles;
     sc_clock clk("clk", 1, SC_NS); ///< Clock signal
     sc_signal<size_t> cycles_; ///< Cycles signal
     sc_signal<size_t> total_hits; ///< Total Hits signal
@@ -40,8 +112,7 @@ struct Result run_simulation(
     sc_signal<size_t> cycles_max; ///< Maximum Cycles signal
 
     // Create instance of the Controller and Result
-    Controller controller("controller", directMapped, requests, num_Requests, cacheLines, CacheLineSize, cacheLatency,
-                          memoryLatency);
+    Controller controller("controller", *config, requests, num_Requests);
     Result result{};
 
     controller.clk(clk);
@@ -67,6 +138,7 @@ struct Result run_simulation(
     result.hits = total_hits.read();
     result.misses = total_misses.read();
     result.primitiveGateCount = primitiveGateCount.read();
+    controller.report(result);
 
     if (trace)
     {
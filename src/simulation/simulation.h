@@ -4,12 +4,326 @@
 
 #include <stddef.h>
 #include <stdint.h>
-#include <systemc>
+#include <stdio.h>
+
+// This header is shared with the C frontend
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Replacement policies of the cache
+ */
+enum ReplacementPolicy
+{
+    POLICY_LRU, ///< Least Recently Used
+    POLICY_FIFO, ///< First In First Out
+    POLICY_RANDOM, ///< Random
+    POLICY_PLRU, ///< Tree pseudo-LRU (ways must be a power of two)
+    POLICY_SRRIP, ///< Static Re-Reference Interval Prediction
+    POLICY_BRRIP, ///< Bimodal Re-Reference Interval Prediction
+    POLICY_LFU ///< Least Frequently Used
+};
+
+/**
+ * Inclusion policies between the levels of a cache hierarchy
+ */
+enum InclusionPolicy
+{
+    INCLUSION_INCLUSIVE, ///< Every block of a level is also held by all levels below it (back-invalidation)
+    INCLUSION_EXCLUSIVE, ///< A block is held by at most one level, victims move one level down
+    INCLUSION_NINE ///< Non-inclusive non-exclusive, fills go to all levels but evictions are not propagated
+};
+
+/**
+ * Write policies of the cache hierarchy
+ */
+enum WritePolicy
+{
+    WRITE_THROUGH, ///< Every write goes on to memory
+    WRITE_BACK ///< Writes stay in the cache, dirty blocks are written to memory when they are evicted
+};
+
+/**
+ * Engines that can run a simulation
+ */
+enum SimulationEngine
+{
+    ENGINE_SYSTEMC, ///< Signal-level SystemC model, the reference
+    ENGINE_FAST, ///< Plain loop over the requests computing the same result, no trace file
+    ENGINE_TLM ///< TLM-2.0 loosely-timed model with temporal decoupling, same result, no trace file
+};
+
+/**
+ * Row buffer policies of the DRAM
+ */
+enum PagePolicy
+{
+    PAGE_OPEN, ///< Rows stay open until an access to another row of the bank
+    PAGE_CLOSED ///< Rows are precharged right after every access
+};
+
+/**
+ * Prefetchers attached to L1
+ */
+enum PrefetcherKind
+{
+    PREFETCH_NONE,
+    PREFETCH_NEXT_LINE, ///< Next N blocks after every miss
+    PREFETCH_STRIDE, ///< Stride table indexed by address region
+    PREFETCH_STREAM ///< Stream buffers running ahead of sequential misses
+};
+
+/**
+ * Coherence protocols between the private caches of a multi-core trace
+ */
+enum CoherenceProtocol
+{
+    COHERENCE_MESI,
+    COHERENCE_MOESI ///< MESI with an Owned state, dirty blocks are shared without writing them back first
+};
+
+/**
+ * Interconnects between the private caches of a multi-core trace
+ */
+enum Interconnect
+{
+    INTERCONNECT_BUS, ///< Snooping bus, every transaction is broadcast and they are serialized
+    INTERCONNECT_DIRECTORY ///< Directory next to the memory, only the caches holding a block are contacted
+};
+
+#define MAX_CACHE_LEVELS 4 ///< Maximum number of cache levels between the controller and the memory
+#define MAX_CORES 64 ///< Maximum number of cores of a multi-core trace
+#define MAX_HOT_LINES 8 ///< Number of most invalidated lines reported
+#define EVENT_EVICTION 0x1 ///< Flag of an Event whose request made L1 evict a block
+#define LATENCY_SUB_BITS 4 ///< Each power of two of request latencies is split into 2^LATENCY_SUB_BITS buckets
+#define LATENCY_BUCKETS ((32 - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) ///< Buckets of the latency histogram
+#define MAX_INTERVALS 1024 ///< Maximum number of intervals of the hit rate series
+
+/**
+ * Structure describing one level of the cache hierarchy
+ */
+struct CacheLevelConfig
+{
+    unsigned cacheLines; ///< Number of cache lines
+    unsigned cacheLineSize; ///< Size of a cache line
+    unsigned ways; ///< Associativity (1 = direct mapped, cacheLines = fully associative)
+    unsigned latency; ///< Latency of a lookup in cycles
+};
+
+/**
+ * Structure describing the DRAM timing model
+ */
+struct DramConfig
+{
+    unsigned channels; ///< Number of channels with their own data bus, 0 charges the flat memory latency instead
+    unsigned banks; ///< Number of banks per channel
+    unsigned rowSize; ///< Number of addresses per row
+    unsigned tRCD; ///< Cycles from activating a row to reading a column
+    unsigned tCAS; ///< Cycles from reading a column to the data
+    unsigned tRP; ///< Cycles to precharge (close) a row
+    unsigned tBurst; ///< Cycles the data bus is busy per word
+    int pagePolicy; ///< Row buffer policy (enum PagePolicy)
+};
+
+/**
+ * Structure selecting the requests written to the event log, all ranges are inclusive
+ */
+struct EventFilter
+{
+    uint64_t firstRequest; ///< Index of the first request logged
+    uint64_t lastRequest; ///< Index of the last request logged
+    uint64_t firstCycle; ///< Requests starting before this cycle are not logged
+    uint64_t lastCycle; ///< Requests starting after this cycle are not logged
+    uint32_t lowAddress; ///< Lowest address logged
+    uint32_t highAddress; ///< Highest address logged
+    int missesOnly; ///< Only log the requests L1 did not serve
+};
+
+/**
+ * Structure describing a whole simulation run
+ */
+struct SimulationConfig
+{
+    int cycles; ///< Maximum number of cycles
+    int engine; ///< Engine running the simulation (enum SimulationEngine)
+    unsigned quantum; ///< Time quantum of the TLM engine in cycles (0 synchronizes after every request)
+    unsigned memoryLatency; ///< Latency of the memory in cycles
+    struct DramConfig dram; ///< DRAM timing model replacing the flat memory latency if dram.channels is set
+    unsigned mshrs; ///< Miss status holding registers of L1, 0 for a blocking cache
+    unsigned issueWindow; ///< Requests in flight at once with a non-blocking cache (mshrs > 0)
+    int prefetcher; ///< Prefetcher of L1 (enum PrefetcherKind)
+    unsigned prefetchDegree; ///< Blocks fetched ahead per trigger (next-line, stride) or per stream (stream)
+    unsigned prefetchEntries; ///< Entries of the stride table or number of stream buffers
+    unsigned victimEntries; ///< Blocks of the fully associative victim cache behind L1, 0 for none
+    unsigned victimLatency; ///< Latency of a victim cache lookup in cycles
+    unsigned cores; ///< Cores issuing the requests, each with a private L1 kept coherent (1 = single core)
+    int coherence; ///< Coherence protocol of a multi-core run (enum CoherenceProtocol)
+    int interconnect; ///< Interconnect of a multi-core run (enum Interconnect)
+    unsigned coherenceLatency; ///< Cycles of a bus transaction or of a directory lookup or forward
+    int policy; ///< Replacement policy of all levels (enum ReplacementPolicy)
+    int inclusion; ///< Inclusion policy between the levels (enum InclusionPolicy)
+    int writePolicy; ///< Write policy of all levels (enum WritePolicy)
+    int writeAllocate; ///< Allocate a block on a write miss (false: the write goes around the cache)
+    int mmapMemory; ///< Keep the memory in one anonymous mapping of the address space instead of a page table
+    int discardReadData; ///< Do not store the data read into the requests, so they can be shared read-only
+    FILE* eventLog; ///< Event log the requests are written to, positioned after its header, null to log nothing
+    struct EventFilter eventFilter; ///< Requests written to the event log
+    size_t statsInterval; ///< Requests per interval of the hit rate series, 0 for no series
+    unsigned numLevels; ///< Number of cache levels, L1 first
+    struct CacheLevelConfig levels[MAX_CACHE_LEVELS]; ///< Cache levels, L1 first
+};
+
+/**
+ * Structure representing a request for the cache (memory request)
+ */
+struct Request
+{
+    uint32_t addr; ///< Memory address
+    uint32_t data; ///< Requested Data
+    uint8_t we; ///< WriteEnabled (true or false)
+    uint8_t core; ///< Core issuing the request (below MAX_CORES)
+    uint8_t reserved[2]; ///< Always 0, the padding is spelled out so requests written to a file hold no stale bytes
+};
+
+/**
+ * Structure representing one request in the event log, the records of the log are these structures as they are laid
+ * out in memory
+ */
+struct Event
+{
+    uint64_t request; ///< Index of the request in the trace
+    uint64_t cycle; ///< Cycles of the run before the request
+    uint32_t addr; ///< Memory address
+    uint32_t latency; ///< Cycles the request added to the run
+    uint32_t evicted; ///< Base address of the block L1 evicted for the request, if flags has EVENT_EVICTION
+    uint8_t we; ///< WriteEnabled (true or false)
+    int8_t level; ///< Level that held the word, 0 for an L1 hit, -1 if no level held it
+    uint8_t flags; ///< EVENT_EVICTION
+    uint8_t reserved; ///< Always 0
+};
+
+/**
+ * Structure representing the statistics of one cache level
+ */
+struct LevelStats
+{
+    size_t hits; ///< Lookups that found the requested word in this level
+    size_t misses; ///< Lookups that did not find the requested word in this level
+    size_t backInvalidations; ///< Blocks dropped from this level to keep a lower level inclusive
+    size_t evictions; ///< Blocks replaced to make room for another block
+    double amat; ///< Average access time seen from this level (latency + local miss rate * next level's AMAT)
+};
+
+/**
+ * Structure representing the statistics of the DRAM
+ */
+struct DramStats
+{
+    size_t accesses; ///< Word accesses
+    size_t rowHits; ///< Accesses to the open row of their bank
+    size_t rowConflicts; ///< Accesses that had to close another row first, the rest found their bank closed
+    size_t queueCycles; ///< Cycles accesses waited for a busy bank or data bus
+    size_t latencyCycles; ///< Cycles from issue to completion, summed over all accesses
+};
+
+/**
+ * Structure representing a cache line that often moved between cores
+ */
+struct HotLine
+{
+    uint32_t addr; ///< Base address of the line
+    size_t invalidations; ///< Copies of the line invalidated by writes of other cores
+    size_t falseSharing; ///< Invalidations of copies that never accessed the word written
+};
+
+/**
+ * Structure representing one interval of the hit rate series
+ */
+struct IntervalStats
+{
+    size_t requests; ///< Requests of the interval, statsInterval except for the last one
+    size_t hits; ///< Requests L1 served
+};
+
+/**
+ * Structure representing the statistics of the requests.
+ * The latency histogram is log-linear: latencies below 2^LATENCY_SUB_BITS have a bucket each, above that every power
+ * of two [2^e, 2^(e+1)) is split into 2^LATENCY_SUB_BITS buckets of equal width, so a bucket is at most 1/16 of its
+ * latencies wide. Latencies from 2^32 on are counted in the last bucket.
+ */
+struct RequestStats
+{
+    size_t reads; ///< Read requests
+    size_t readHits; ///< Read requests L1 served
+    size_t writes; ///< Write requests
+    size_t writeHits; ///< Write requests L1 served
+    size_t coldLines; ///< L1 blocks referenced for the first time, each one a compulsory miss unless prefetched
+    size_t totalLatency; ///< Cycles the requests added to the run, summed
+    size_t latencyP50; ///< Median latency, the upper bound of its bucket (exact below 2^LATENCY_SUB_BITS)
+    size_t latencyP90; ///< 90th percentile latency, like latencyP50
+    size_t latencyP99; ///< 99th percentile latency, like latencyP50
+    size_t maxLatency; ///< Longest latency, exact
+    size_t latencyHistogram[LATENCY_BUCKETS]; ///< Requests per latency bucket
+    size_t intervalRequests; ///< Requests per interval, statsInterval doubled as often as MAX_INTERVALS required
+    unsigned numIntervals; ///< Number of intervals reported in intervals
+    struct IntervalStats intervals[MAX_INTERVALS]; ///< Hit rate series, first interval first
+};
+
+/**
+ * Structure representing the result of a SystemC Cache Simulation
+ */
+struct Result
+{
+    size_t cycles; ///< Number of cycles needed to complete the simulation
+    size_t misses; ///< Number of total misses occured during the simulation
+    size_t hits; ///< Number of total hits occured during the simulation
+    size_t primitiveGateCount; ///< Number of primitive Gates needed to realize such Cache
+    unsigned numLevels; ///< Number of cache levels reported in levels
+    struct LevelStats levels[MAX_CACHE_LEVELS]; ///< Statistics per cache level, L1 first
+    double amat; ///< Average memory access time of the hierarchy in cycles
+    size_t memoryReads; ///< Words read from memory
+    size_t memoryWrites; ///< Words written to memory, by write-through and by write-backs
+    size_t writebacks; ///< Dirty blocks written back to memory
+    struct DramStats dram; ///< DRAM statistics, all 0 with the flat memory latency
+    size_t mshrMerges; ///< Reads merged into the outstanding miss of their block (non-blocking cache)
+    size_t mshrStallCycles; ///< Cycles misses waited for a free MSHR (non-blocking cache)
+    size_t prefetchIssued; ///< Blocks fetched by the prefetcher
+    size_t prefetchUseful; ///< Prefetched blocks used by a demand access before leaving L1
+    size_t prefetchLate; ///< Useful prefetches whose block had not arrived when it was used
+    size_t prefetchPolluting; ///< Demand misses on blocks a prefetch had evicted from L1
+    size_t victimHits; ///< L1 misses served by the victim cache
+    size_t victimMisses; ///< L1 misses the victim cache could not serve
+    size_t victimSwaps; ///< Blocks swapped from the victim cache back into L1
+    unsigned numCores; ///< Number of cores reported in coreCycles
+    size_t coreCycles[MAX_CORES]; ///< Cycles each core needed for its requests (multi-core)
+    size_t coherenceMessages; ///< Bus transactions or directory messages (multi-core)
+    size_t invalidations; ///< Copies invalidated by writes of other cores (multi-core)
+    size_t cacheToCacheTransfers; ///< Misses served by the dirty copy of another core (multi-core)
+    size_t falseSharingInvalidations; ///< Invalidations of copies that never accessed the word written (multi-core)
+    unsigned numHotLines; ///< Number of lines reported in hotLines
+    struct HotLine hotLines[MAX_HOT_LINES]; ///< Most invalidated lines, most invalidations first
+    size_t loggedEvents; ///< Events written to the event log
+    struct RequestStats stats; ///< Latencies, hit rates and the hit rate series of the requests
+};
+
+/**
+ * Structure representing one point of a miss-ratio curve
+ */
+struct MissRatioPoint
+{
+    unsigned cacheLines; ///< Number of cache lines of the fully associative LRU cache
+    size_t hits; ///< Requests that hit
+    size_t misses; ///< Requests that missed
+    size_t cycles; ///< Cycles the requests take with this cache, SIZE_MAX if they run out of config->cycles
+};
 
 /**
  * Function prototype (Decleration) of running the SystemC Cache Simulation
  * @param cycles
  * @param directMapped
+ * @param ways associativity, 0 selects fully associative (ignored if directMapped is set)
+ * @param policy replacement policy (enum ReplacementPolicy)
  * @param cacheLines
  * @param CacheLineSize
  * @param cacheLatency
@@ -19,9 +333,11 @@
  * @param tracefile
  * @return Result
  */
-extern "C" struct Result run_simulation(
+struct Result run_simulation(
     int cycles,
     int directMapped,
+    unsigned ways,
+    int policy,
     unsigned cacheLines,
     unsigned CacheLineSize,
     unsigned cacheLatency,
@@ -31,24 +347,59 @@ extern "C" struct Result run_simulation(
     const char* tracefile);
 
 /**
- * Structure representing a request for the cache (memory request)
+ * Function prototype (Decleration) of running the SystemC Cache Simulation for a cache hierarchy
+ * @param config
+ * @param num_Requests
+ * @param requests
+ * @param tracefile
+ * @return Result
  */
-struct Request
-{
-    uint32_t addr; ///< Memory address
-    uint32_t data; ///< Requested Data
-    int we; ///< WriteEnabled (true or false)
-};
+struct Result run_simulation_with_config(
+    const struct SimulationConfig* config,
+    size_t num_Requests,
+    struct Request* requests,
+    const char* tracefile);
 
 /**
- * Structure representing the result of a SystemC Cache Simulation
+ * Function prototype (Decleration) of computing the miss-ratio curve of a fully associative, write-through LRU cache
+ * for every number of cache lines in one pass
+ * @param config L1 line size and latency, the memory latency and the largest number of cache lines
+ * @param num_Requests
+ * @param requests
+ * @param points receives config->levels[0].cacheLines points, one cache line first
  */
-struct Result
-{
-    size_t cycles; ///< Number of cycles needed to complete the simulation
-    size_t misses; ///< Number of total misses occured during the simulation
-    size_t hits; ///< Number of total hits occured during the simulation
-    size_t primitiveGateCount; ///< Number of primitive Gates needed to realize such Cache
-};
+void run_miss_ratio_curve(
+    const struct SimulationConfig* config,
+    size_t num_Requests,
+    const struct Request* requests,
+    struct MissRatioPoint* points);
+
+/**
+ * Source of the requests of a streamed simulation, it fills the buffer with the next requests of the trace and blocks
+ * until at least one is available
+ * @param context passed through from run_streaming_simulation
+ * @param requests buffer receiving the requests
+ * @param max size of the buffer
+ * @return number of requests stored, 0 at the end of the trace
+ */
+typedef size_t (*RequestSource)(void* context, struct Request* requests, size_t max);
+
+/**
+ * Function prototype (Decleration) of running the fast engine on requests pulled from a source batch by batch, memory
+ * use does not depend on the length of the trace. Only single core hierarchies are supported, the data read is not
+ * handed back.
+ * @param config
+ * @param source
+ * @param context passed to every call of source
+ * @return Result
+ */
+struct Result run_streaming_simulation(
+    const struct SimulationConfig* config,
+    RequestSource source,
+    void* context);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif //SIMULATION_H
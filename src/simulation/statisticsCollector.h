@@ -0,0 +1,185 @@
+#ifndef STATISTICSCOLLECTOR_H
+#define STATISTICSCOLLECTOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "simulation.h"
+
+/**
+ * Statistics of the requests of a run: latency histogram, read and write hit rates, cold lines and the hit rate
+ * series. A request costs a few counter increments and one bit test, cheap enough to always collect them.
+ */
+class StatisticsCollector
+{
+public:
+    const unsigned OFFSET_BITS; ///< Number of offset bits of an L1 block
+
+    /**
+     * Constructor of the Collector
+     * @param config L1 line size and statsInterval
+     */
+    explicit StatisticsCollector(const SimulationConfig& config) :
+        OFFSET_BITS(log2(config.levels[0].cacheLineSize)),
+        seen(((size_t{1} << (32 - OFFSET_BITS)) >> PAGE_BITS) + 1)
+    {
+        stats.intervalRequests = config.statsInterval;
+    }
+
+    /**
+     * Count a finished request
+     * @param addr
+     * @param we
+     * @param hit whether L1 served the request
+     * @param latency cycles the request added to the run
+     */
+    void record(const uint32_t addr, const bool we, const bool hit, const size_t latency)
+    {
+        if (we)
+        {
+            stats.writes++;
+            stats.writeHits += hit;
+        }
+        else
+        {
+            stats.reads++;
+            stats.readHits += hit;
+        }
+
+        const uint32_t block = addr >> OFFSET_BITS;
+        std::unique_ptr<uint64_t[]>& page = seen[block >> PAGE_BITS];
+        if (!page)
+        {
+            page.reset(new uint64_t[PAGE_BLOCKS / 64]());
+        }
+        uint64_t& word = page[(block & (PAGE_BLOCKS - 1)) / 64];
+        const uint64_t bit = uint64_t{1} << (block % 64);
+        if (!(word & bit))
+        {
+            word |= bit;
+            stats.coldLines++;
+        }
+
+        stats.latencyHistogram[bucket_of(latency)]++;
+        stats.totalLatency += latency;
+        if (latency > stats.maxLatency)
+        {
+            stats.maxLatency = latency;
+        }
+
+        if (stats.intervalRequests != 0)
+        {
+            IntervalStats& interval = stats.intervals[stats.numIntervals];
+            interval.requests++;
+            interval.hits += hit;
+            if (interval.requests == stats.intervalRequests && ++stats.numIntervals == MAX_INTERVALS)
+            {
+                merge_intervals();
+            }
+        }
+    }
+
+    /**
+     * Store the statistics in a result, with the percentiles of the histogram
+     * @param result
+     */
+    void report(Result& result) const
+    {
+        result.stats = stats;
+        RequestStats& reported = result.stats;
+        if (reported.intervalRequests != 0 && reported.intervals[reported.numIntervals].requests != 0)
+        {
+            reported.numIntervals++; ///< The last, partial interval
+        }
+        reported.latencyP50 = percentile(50);
+        reported.latencyP90 = percentile(90);
+        reported.latencyP99 = percentile(99);
+    }
+
+private:
+    static constexpr unsigned PAGE_BITS = 16; ///< Block bits selecting the bit within a page of the seen blocks
+    static constexpr size_t PAGE_BLOCKS = size_t{1} << PAGE_BITS; ///< Blocks per page (8 KiB of bits)
+    static constexpr unsigned SUB_BUCKETS = 1u << LATENCY_SUB_BITS; ///< Buckets per power of two
+
+    RequestStats stats{}; ///< Statistics collected so far, intervals[numIntervals] is the interval being filled
+    std::vector<std::unique_ptr<uint64_t[]>> seen; ///< Bit per L1 block that was referenced, pages allocated on use
+
+    /**
+     * @param latency
+     * @return histogram bucket of the latency, see RequestStats
+     */
+    static unsigned bucket_of(const size_t latency)
+    {
+        if (latency < SUB_BUCKETS)
+        {
+            return static_cast<unsigned>(latency);
+        }
+        if (latency > UINT32_MAX)
+        {
+            return LATENCY_BUCKETS - 1;
+        }
+        const unsigned exponent = 31 - __builtin_clz(static_cast<uint32_t>(latency)); ///< At least LATENCY_SUB_BITS
+        const unsigned sub = (latency >> (exponent - LATENCY_SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (exponent - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS | sub;
+    }
+
+    /**
+     * @param bucket
+     * @return largest latency counted in a bucket
+     */
+    static size_t bucket_high(const unsigned bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        const unsigned group = bucket >> LATENCY_SUB_BITS;
+        const size_t sub = bucket & (SUB_BUCKETS - 1);
+        return ((SUB_BUCKETS + sub + 1) << (group - 1)) - 1;
+    }
+
+    /**
+     * @param percent
+     * @return latency percent of the requests did not exceed, the upper bound of its bucket but at most maxLatency
+     */
+    size_t percentile(const unsigned percent) const
+    {
+        const size_t requests = stats.reads + stats.writes;
+        const size_t rank = (requests * percent + 99) / 100; ///< Requests at or below the percentile
+        size_t counted = 0;
+        for (unsigned bucket = 0; bucket < LATENCY_BUCKETS && requests != 0; ++bucket)
+        {
+            counted += stats.latencyHistogram[bucket];
+            if (counted >= rank)
+            {
+                return std::min(bucket_high(bucket), stats.maxLatency);
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * Halve the number of intervals by merging neighbours, the series keeps covering the whole run at half the
+     * resolution
+     */
+    void merge_intervals()
+    {
+        for (unsigned i = 0; i < MAX_INTERVALS / 2; ++i)
+        {
+            stats.intervals[i].requests = stats.intervals[2 * i].requests + stats.intervals[2 * i + 1].requests;
+            stats.intervals[i].hits = stats.intervals[2 * i].hits + stats.intervals[2 * i + 1].hits;
+        }
+        for (unsigned i = MAX_INTERVALS / 2; i < MAX_INTERVALS; ++i)
+        {
+            stats.intervals[i] = IntervalStats{};
+        }
+        stats.numIntervals = MAX_INTERVALS / 2;
+        stats.intervalRequests *= 2;
+    }
+};
+
+#endif //STATISTICSCOLLECTOR_H
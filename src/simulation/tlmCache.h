@@ -0,0 +1,192 @@
+#ifndef TLMCACHE_H
+#define TLMCACHE_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/simple_target_socket.h>
+
+#include "cacheHierarchy.h"
+#include "simulation.h"
+
+using namespace sc_core;
+
+/**
+ * Extension of the payloads sent to the TLM cache, tells the initiator whether the request hit in L1
+ */
+struct CacheHitExtension : tlm::tlm_extension<CacheHitExtension>
+{
+    bool hit = false; ///< Whether L1 held the requested word
+
+    tlm::tlm_extension_base* clone() const override
+    {
+        return new CacheHitExtension(*this);
+    }
+
+    void copy_from(const tlm::tlm_extension_base& other) override
+    {
+        hit = static_cast<const CacheHitExtension&>(other).hit;
+    }
+};
+
+/**
+ * Cache Module of the TLM-2.0 loosely-timed model, standing for the whole hierarchy like Cache.
+ * Every request is one blocking transport call that annotates the cycles Cache would have reported.
+ */
+class TlmCache : public sc_module
+{
+public:
+    virtual tlm::tlm_target_socket<>& target_socket() = 0; ///< Requests from the controller
+    virtual tlm::tlm_initiator_socket<>& initiator_socket() = 0; ///< Requests to the memory
+
+    /**
+     * Write the per-level statistics of the hierarchy into a result, only called once the simulation has stopped
+     * @param result
+     */
+    virtual void report(Result& result) const = 0;
+
+protected:
+    explicit TlmCache(sc_module_name name) : sc_module(name)
+    {
+    }
+};
+
+/**
+ * TLM Cache Module specialized on a replacement policy
+ * @tparam Policy replacement policy, see replacementPolicy.h
+ */
+template <class Policy>
+class PolicyTlmCache final : public TlmCache
+{
+public:
+    tlm_utils::simple_target_socket<PolicyTlmCache> target; ///< Requests from the controller
+    tlm_utils::simple_initiator_socket<PolicyTlmCache> initiator; ///< Requests to the memory
+
+    /**
+     * Constructor of the Module
+     * @param name
+     * @param config
+     */
+    PolicyTlmCache(sc_module_name name, const SimulationConfig& config) :
+        TlmCache(name),
+        target("target"),
+        initiator("initiator"),
+        hierarchy(config)
+    {
+        target.register_b_transport(this, &PolicyTlmCache::b_transport);
+    }
+
+    tlm::tlm_target_socket<>& target_socket() override { return target; }
+
+    tlm::tlm_initiator_socket<>& initiator_socket() override { return initiator; }
+
+    void report(Result& result) const override
+    {
+        hierarchy.report(result);
+    }
+
+private:
+    CacheHierarchy<Policy> hierarchy; ///< Functional and timing model of the cache levels
+    tlm::tlm_generic_payload memory_trans; ///< Payload reused for every memory access
+    uint32_t memory_data = 0; ///< Data word of memory_trans
+
+    /**
+     * Serve one request of the controller
+     * @param trans
+     * @param delay incremented by the cycles of the access
+     */
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+    {
+        uint32_t* data = reinterpret_cast<uint32_t*>(trans.get_data_ptr());
+        const uint32_t addr = static_cast<uint32_t>(trans.get_address());
+
+        HierarchyAccess access{};
+        if (trans.is_write())
+        {
+            access = hierarchy.write(addr, *data);
+        }
+        else if ((access = hierarchy.read(addr, *data)).level < 0) ///< Read miss in every level
+        {
+            drain_writes(delay); ///< Memory has to be up to date before it is read
+            *data = memory_access(tlm::TLM_READ_COMMAND, addr, 0, delay);
+            access.cycles += hierarchy.fill(addr, *data);
+        }
+        drain_writes(delay);
+        prefetch(delay);
+
+        CacheHitExtension* hit = nullptr;
+        trans.get_extension(hit);
+        if (hit)
+        {
+            hit->hit = access.level == 0;
+        }
+        delay += sc_time(static_cast<double>(access.cycles), SC_NS); ///< One cycle per 1 ns clock period
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+    /**
+     * Send the words the hierarchy queued for memory
+     * @param delay
+     */
+    void drain_writes(sc_time& delay)
+    {
+        for (const MemoryWrite& write : hierarchy.pending_writes())
+        {
+            memory_access(tlm::TLM_WRITE_COMMAND, write.addr, write.data, delay);
+        }
+        hierarchy.clear_pending_writes();
+    }
+
+    /**
+     * Read the words the hierarchy wants to prefetch from memory and hand them back to it
+     * @param delay
+     */
+    void prefetch(sc_time& delay)
+    {
+        for (const uint32_t word : hierarchy.issue_prefetches())
+        {
+            hierarchy.prefetch_fill(word, memory_access(tlm::TLM_READ_COMMAND, word, 0, delay));
+        }
+        drain_writes(delay); ///< Dirty blocks the prefetches evicted
+    }
+
+    /**
+     * Read or write one word of memory
+     * @param command
+     * @param addr
+     * @param data word to write
+     * @param delay
+     * @return word read
+     */
+    uint32_t memory_access(const tlm::tlm_command command, const uint32_t addr, const uint32_t data, sc_time& delay)
+    {
+        memory_data = data;
+        memory_trans.set_command(command);
+        memory_trans.set_address(addr);
+        memory_trans.set_data_ptr(reinterpret_cast<unsigned char*>(&memory_data));
+        memory_trans.set_data_length(sizeof(memory_data));
+        memory_trans.set_streaming_width(sizeof(memory_data));
+        memory_trans.set_byte_enable_ptr(nullptr);
+        memory_trans.set_dmi_allowed(false);
+        memory_trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        initiator->b_transport(memory_trans, delay);
+        return memory_data;
+    }
+};
+
+/**
+ * Create the TLM Cache Module for the configured replacement policy
+ * @param name
+ * @param config
+ * @return Cache Module, owned by the caller
+ */
+inline TlmCache* create_tlm_cache(const char* name, const SimulationConfig& config)
+{
+    return visit_policy(static_cast<ReplacementPolicy>(config.policy), [&](auto type) -> TlmCache*
+    {
+        using Policy = typename decltype(type)::type;
+        return new PolicyTlmCache<Policy>(name, config);
+    });
+}
+
+#endif //TLMCACHE_H
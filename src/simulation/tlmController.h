@@ -0,0 +1,159 @@
+#ifndef TLMCONTROLLER_H
+#define TLMCONTROLLER_H
+
+#include <cstdint>
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
+
+#include "primitiveGateCountCalc.h"
+#include "statisticsCollector.h"
+#include "tlmCache.h"
+#include "tlmMemory.h"
+
+using namespace sc_core;
+
+/**
+ * Controller Module of the TLM-2.0 loosely-timed model.
+ * The requests are sent as blocking transports whose annotated delays are only synchronized with the kernel once a
+ * time quantum is used up (temporal decoupling), the cycles are the sum of the annotated delays.
+ */
+class TlmController final : public sc_module
+{
+public:
+    tlm_utils::simple_initiator_socket<TlmController> socket; ///< Requests to the cache
+
+    const size_t GATE_COUNT; ///< Primitive gate count of the cache hierarchy
+    const bool STORE_READ_DATA; ///< Whether the data read is stored into the requests
+    const size_t CYCLES_MAX; ///< Maximum number of cycles
+    size_t cycles; ///< Number of Cycles, SIZE_MAX if the requests did not fit into CYCLES_MAX
+    size_t request_counter; ///< Request Counter
+    size_t hit_count; ///< Hit Counter
+    size_t miss_count; ///< Miss Counter
+
+    SC_HAS_PROCESS(TlmController); ///< Macro for multiple-argument constructor of the Module
+
+    /**
+     * Controller Module Constructor
+     * @param name
+     * @param config
+     * @param requests
+     * @param num_requests
+     */
+    TlmController(sc_module_name name, const SimulationConfig& config, struct Request* requests,
+                  const size_t num_requests) :
+        sc_module(name),
+        socket("socket"),
+        GATE_COUNT(::hierarchyGateCount(config)),
+        STORE_READ_DATA(!config.discardReadData),
+        CYCLES_MAX(static_cast<size_t>(config.cycles)),
+        cycles(0),
+        request_counter(0),
+        hit_count(0),
+        miss_count(0),
+        requests(requests),
+        num_requests(num_requests),
+        statistics(config)
+    {
+        tlm_utils::tlm_quantumkeeper::set_global_quantum(sc_time(config.quantum, SC_NS));
+
+        SC_THREAD(controller_process);
+
+        cache = create_tlm_cache("cache", config);
+        memory = new TlmMemory("memory", config.mmapMemory != 0);
+        socket.bind(cache->target_socket());
+        cache->initiator_socket().bind(memory->socket);
+    }
+
+    ~TlmController() override
+    {
+        delete cache;
+        delete memory;
+    }
+
+    /**
+     * Write the counters, the statistics of the cache hierarchy and the request statistics into a result
+     * @param result
+     */
+    void report(Result& result) const
+    {
+        result.cycles = cycles;
+        result.hits = hit_count;
+        result.misses = miss_count;
+        result.primitiveGateCount = GATE_COUNT;
+        cache->report(result);
+        statistics.report(result);
+    }
+
+private:
+    TlmCache* cache; ///< Cache Module
+    TlmMemory* memory; ///< Memory Module
+    struct Request* requests; ///< Array of Requests
+    size_t num_requests; ///< Number of Requests
+    StatisticsCollector statistics; ///< Latencies, hit rates and hit rate series of the requests
+
+    /**
+     * Send all requests to the cache, stopping early like Controller if the cycles run out
+     */
+    void controller_process()
+    {
+        tlm::tlm_generic_payload trans;
+        CacheHitExtension* hit = new CacheHitExtension; ///< Owned and freed by the payload
+        trans.set_extension(hit);
+
+        tlm_utils::tlm_quantumkeeper quantum_keeper;
+        quantum_keeper.reset();
+
+        const sc_time period(1, SC_NS); ///< One cycle
+        while (request_counter < num_requests)
+        {
+            struct Request& request = requests[request_counter];
+            uint32_t data = request.data;
+            trans.set_command(request.we ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+            trans.set_address(request.addr);
+            trans.set_data_ptr(reinterpret_cast<unsigned char*>(&data));
+            trans.set_data_length(sizeof(data));
+            trans.set_streaming_width(sizeof(data));
+            trans.set_byte_enable_ptr(nullptr);
+            trans.set_dmi_allowed(false);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+            sc_time delay = quantum_keeper.get_local_time();
+            const sc_time issued = delay;
+            socket->b_transport(trans, delay);
+            const size_t latency = static_cast<size_t>((delay - issued) / period);
+            cycles += latency;
+            quantum_keeper.set(delay);
+            if (quantum_keeper.need_sync())
+            {
+                quantum_keeper.sync();
+            }
+
+            if (!request.we && STORE_READ_DATA)
+            {
+                request.data = data;
+            }
+            statistics.record(request.addr, request.we, hit->hit, latency);
+            if (hit->hit)
+            {
+                hit_count++;
+            }
+            else
+            {
+                miss_count++;
+            }
+
+            request_counter++;
+            if (request_counter < num_requests && cycles >= CYCLES_MAX) ///< Out of cycles before the last request
+            {
+                cycles = SIZE_MAX;
+                break;
+            }
+        }
+        quantum_keeper.sync();
+        sc_stop();
+    }
+};
+
+#endif //TLMCONTROLLER_H
@@ -0,0 +1,59 @@
+#ifndef TLMMEMORY_H
+#define TLMMEMORY_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_target_socket.h>
+
+#include "pagedMemory.h"
+
+using namespace sc_core;
+
+/**
+ * Memory Module of the TLM-2.0 loosely-timed model.
+ * It is untimed, the memory latency is part of the cycles the cache annotates.
+ */
+class TlmMemory final : public sc_module
+{
+public:
+    tlm_utils::simple_target_socket<TlmMemory> socket; ///< Requests from the cache
+
+    /**
+     * Constructor of the Module
+     * @param name
+     * @param mmapBacked keep the contents in one anonymous mapping of the whole address space
+     */
+    explicit TlmMemory(sc_module_name name, const bool mmapBacked = false) :
+        sc_module(name),
+        socket("socket"),
+        memory(mmapBacked)
+    {
+        socket.register_b_transport(this, &TlmMemory::b_transport);
+    }
+
+private:
+    PagedMemory memory; ///< Contents of the memory
+
+    /**
+     * Read or write one word
+     * @param trans
+     * @param delay
+     */
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay)
+    {
+        (void)delay;
+        uint32_t* data = reinterpret_cast<uint32_t*>(trans.get_data_ptr());
+        const uint32_t addr = static_cast<uint32_t>(trans.get_address());
+        if (trans.is_write())
+        {
+            memory.write(addr, *data);
+        }
+        else
+        {
+            *data = memory.read(addr);
+        }
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+};
+
+#endif //TLMMEMORY_H